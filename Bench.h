@@ -0,0 +1,206 @@
+/*
+  Bench.h - Times the firmware's hot routines on the board itself, run
+  from the serial shell with 'bench [name]'
+  Created by D. Aaron Wisner
+  Released into the public domain.
+
+  Every routine runs a fixed number of times back to back and prints one
+  line per benchmark, easy to diff between builds:
+    bench <name> <iterations> <total us> <ns per iteration>
+  micros() only ticks every 4us, so the counts are picked to run for at
+  least ~20ms each. 'none' is the empty loop, subtract it for the small ones.
+  Interrupts stay on, so the Timer0, USART and button ticks are in there too.
+
+  Door service, the cooler and menu drawing depend on whatever state the
+  feeder is in, host/bench_firmware.cpp times those with each state forced.
+*/
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "Arduino.h"
+#include <avr/wdt.h>
+#include <RingBufCPP.h>
+#include "TimeLib.h"
+#include "FeederUtils.h"
+#include "FeederConfig.h"
+#ifndef NO_HEAP
+#include <RingBuf.h>
+#endif
+
+#define BENCH_NAME_SIZE 10
+
+typedef struct Benchmark
+{
+    char name[BENCH_NAME_SIZE];
+    void (*fn)(uint16_t iters);
+    uint16_t iters;
+} Benchmark;
+
+extern double getFastTemp();
+
+// Results go here so the compiler can't drop the work
+volatile uint32_t benchSink;
+
+void benchNone(uint16_t iters);
+void benchCrc(uint16_t iters);
+void benchBreakTime(uint16_t iters);
+void benchMakeTime(uint16_t iters);
+void benchNow(uint16_t iters);
+void benchRingBuf(uint16_t iters);
+void benchRingBufCPP(uint16_t iters);
+void benchRingBulk(uint16_t iters);
+void benchLog(uint16_t iters);
+void benchFastTemp(uint16_t iters);
+bool benchRun(const Benchmark &b);
+
+const Benchmark benchmarks[] PROGMEM = {
+    { "none", &benchNone, 10000 },
+    // One feed compartment's worth of settings
+    { "crc", &benchCrc, 200 },
+    { "breaktime", &benchBreakTime, 2000 },
+    { "maketime", &benchMakeTime, 2000 },
+    { "now", &benchNow, 5000 },
+    // One add and one pull of a byte, the C library and the template
+#ifndef NO_HEAP
+    { "ringbuf", &benchRingBuf, 2000 },
+#endif
+    { "ringcpp", &benchRingBufCPP, 5000 },
+    // 32 bytes in and out, like a WifiUart chunk
+    { "ringbulk", &benchRingBulk, 1000 },
+    // Everything LOG() does except printing
+    { "log", &benchLog, 200 },
+    // One DS3232 temperature read, what the cooler waits on every pass
+    { "fasttemp", &benchFastTemp, 100 },
+};
+
+void benchNone(uint16_t iters)
+{
+    for (uint16_t i = 0; i < iters; i++) benchSink = i;
+}
+
+void benchCrc(uint16_t iters)
+{
+    for (uint16_t i = 0; i < iters; i++)
+    {
+        benchSink = EEGenerateCrc(EEPROM_FEEDER_SETTING_LOC, FEED_COMPART_EE_SIZE);
+    }
+}
+
+void benchBreakTime(uint16_t iters)
+{
+    tmElements_t tm;
+    time_t t = now();
+    // A day and a bit apart, so every call lands on a different date
+    for (uint16_t i = 0; i < iters; i++, t += 90061UL)
+    {
+        breakTime(t, tm);
+        benchSink = tm.Day;
+    }
+}
+
+void benchMakeTime(uint16_t iters)
+{
+    tmElements_t tm;
+    breakTime(now(), tm);
+    for (uint16_t i = 0; i < iters; i++)
+    {
+        tm.Day = 1 + i % 28;
+        benchSink = makeTime(tm);
+    }
+}
+
+void benchNow(uint16_t iters)
+{
+    for (uint16_t i = 0; i < iters; i++) benchSink = now();
+}
+
+#ifndef NO_HEAP
+// RingBuf_init() mallocs, so this one only exists with the heap
+void benchRingBuf(uint16_t iters)
+{
+    static RingBuf rb;
+    static bool ready = false;
+    // Allocated once and kept, the first bench run pays for it
+    if (!ready) ready = RingBuf_init(&rb, sizeof(uint8_t), 16) == 0;
+    if (!ready) return;
+
+    uint8_t c;
+    for (uint16_t i = 0; i < iters; i++)
+    {
+        c = i;
+        RingBufAdd(&rb, &c);
+        RingBufPull(&rb, &c);
+        benchSink = c;
+    }
+}
+#endif
+
+void benchRingBufCPP(uint16_t iters)
+{
+    static RingBufCPP<uint8_t, 16> rb;
+    uint8_t c;
+    for (uint16_t i = 0; i < iters; i++)
+    {
+        rb.add((uint8_t)i);
+        rb.pull(c);
+        benchSink = c;
+    }
+}
+
+void benchRingBulk(uint16_t iters)
+{
+    static RingBufCPP<uint8_t, 64> rb;
+    uint8_t chunk[32];
+    for (uint16_t i = 0; i < iters; i++)
+    {
+        rb.add(chunk, sizeof(chunk));
+        rb.pull(chunk, sizeof(chunk));
+        benchSink = chunk[0];
+    }
+}
+
+void benchLog(uint16_t iters)
+{
+    char buf[ERROR_BUF_SIZE];
+    for (uint16_t i = 0; i < iters; i++)
+    {
+        uint16_t n = createDebugString(buf, sizeof(buf), __LINE__, LOG_DEBUG);
+        snprintf_P(buf + n, MAX(0, sizeof(buf) - n), PSTR("System Temp %dF (%d%%)"), 72, 50);
+        benchSink = buf[0];
+    }
+}
+
+void benchFastTemp(uint16_t iters)
+{
+    for (uint16_t i = 0; i < iters; i++) benchSink = (uint32_t)getFastTemp();
+}
+
+bool benchRun(const Benchmark &b)
+{
+    // A few hundred ms at most, but the shell blocks for all of them
+    wdt_reset();
+    unsigned long start = micros();
+    b.fn(b.iters);
+    unsigned long us = micros() - start;
+
+    shellPrintf(PSTR("bench %s %u %lu %lu"), b.name, b.iters, us, us * 1000UL / b.iters);
+    return true;
+}
+
+// bench runs all of them, bench <name> just the one
+bool shellBench(uint8_t argc, char **argv)
+{
+    Benchmark b;
+    bool found = false;
+
+    if (argc > 2) return false;
+    for (uint8_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+    {
+        memcpy_P(&b, &benchmarks[i], sizeof(b));
+        if (argc == 2 && strcmp(b.name, argv[1])) continue;
+        found = benchRun(b);
+    }
+    return found;
+}
+
+#endif
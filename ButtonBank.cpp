@@ -0,0 +1,38 @@
+#include "ButtonBank.h"
+
+ButtonBank::ButtonBank(volatile uint8_t *pinReg, uint8_t mask)
+: pinReg(pinReg), mask(mask)
+{
+    state = 0;
+    // Counters idle at 3, the next change starts them from 0
+    ct0 = 0xFF;
+    ct1 = 0xFF;
+    pressedIsr = 0;
+    releasedIsr = 0;
+    pressedMask = 0;
+    releasedMask = 0;
+}
+
+void ButtonBank::begin()
+{
+    // The PORT register sits 2 above PIN on every AVR port
+    volatile uint8_t *ddr = pinReg + 1;
+    volatile uint8_t *port = pinReg + 2;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        *ddr &= ~mask;
+        *port |= mask;
+    }
+}
+
+void ButtonBank::update()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pressedMask = pressedIsr;
+        releasedMask = releasedIsr;
+        pressedIsr = 0;
+        releasedIsr = 0;
+    }
+}
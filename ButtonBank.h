@@ -0,0 +1,73 @@
+/*
+  ButtonBank.h - Debounces every button on one port at once with vertical
+  counters, from a single read of the port's PIN register per tick
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef BUTTON_BANK_H
+#define BUTTON_BANK_H
+
+#include <Arduino.h>
+#include <util/atomic.h>
+
+class ButtonBank
+{
+public:
+    // Buttons pull the pins in mask low when pressed
+    ButtonBank(volatile uint8_t *pinReg, uint8_t mask);
+
+    // Turns on the pullups, everything starts released
+    void begin();
+
+    // Call every 1-2ms from a timer interrupt. A change has to be seen on
+    // 4 ticks in a row before it counts, bit i of ct1:ct0 is the 2 bit
+    // counter of button i so all of them count at the same time.
+    void tick()
+    {
+        uint8_t changed = state ^ (~*pinReg & mask);
+        ct0 = ~(ct0 & changed);
+        ct1 = ct0 ^ (ct1 & changed);
+        // Counters that rolled over flip their button
+        changed &= ct0 & ct1;
+        state ^= changed;
+        pressedIsr |= state & changed;
+        releasedIsr |= ~state & changed;
+    }
+
+    // Takes the edges the ISR saw since the last call, once per pass
+    void update();
+
+    // Went down or up since the last update()
+    uint8_t pressed() { return pressedMask; }
+    uint8_t released() { return releasedMask; }
+    // Down right now
+    uint8_t held() { return state; }
+
+private:
+    volatile uint8_t * const pinReg;
+    const uint8_t mask;
+
+    // Written by tick() only
+    volatile uint8_t state;
+    uint8_t ct0, ct1;
+    volatile uint8_t pressedIsr, releasedIsr;
+
+    uint8_t pressedMask, releasedMask;
+};
+
+// One button of a bank, answers the same calls the Button library did
+class BankButton
+{
+public:
+    BankButton(ButtonBank &bank, uint8_t mask) : bank(bank), mask(mask) {}
+
+    uint8_t isPressed() { return bank.held() & mask; }
+    uint8_t wasPressed() { return bank.pressed() & mask; }
+    uint8_t wasReleased() { return bank.released() & mask; }
+
+private:
+    ButtonBank &bank;
+    const uint8_t mask;
+};
+
+#endif
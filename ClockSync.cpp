@@ -0,0 +1,207 @@
+#include "ClockSync.h"
+
+ClockSync::ClockSync(uint16_t eepromLoc)
+: eepromLoc(eepromLoc)
+{
+    state = IDLE;
+    offset = 0;
+    driftPpb = 0;
+    interval = 0;
+    mcuStart = 0;
+}
+
+void ClockSync::begin()
+{
+    if (!loadSettingsFromEE()) {
+        settings.last_sync = 0;
+        settings.natural_ppb = 0;
+        settings.samples = 0;
+        // Keep whatever trim the RTC already has
+        settings.aging = (int8_t)RTC.readRTC(RTC_AGING);
+        saveSettingsToEE();
+        LOG(LOG_ERROR, "Clock: No previous sync in EEPROM");
+    } else {
+        LOG(LOG_DEBUG, "Clock: Last synced %lu s ago, aging %d", now() - settings.last_sync,
+            settings.aging);
+        // The register is lost with the RTC battery
+        if ((int8_t)RTC.readRTC(RTC_AGING) != settings.aging) writeAging();
+    }
+
+    // setup() starts the system clock at 1 before the RTC takes over
+    mcuStart = now();
+    sysUnsyncedTime = mcuStart;
+}
+
+void ClockSync::request(time_t host_secs, uint16_t host_ms)
+{
+    msRequest = millis();
+    hostSecs = host_secs;
+    hostMs = host_ms % 1000;
+
+    // The seconds register is all we need to catch the next tick
+    rtcSecs = RTC.readRTC(RTC_SECONDS);
+    state = WAIT_TICK;
+}
+
+bool ClockSync::service()
+{
+    switch (state)
+    {
+        case WAIT_TICK:
+            if (RTC.readRTC(RTC_SECONDS) != rtcSecs) {
+                // The RTC is exactly on a whole second now
+                unsigned long ms = millis();
+                time_t rtc = RTC.get();
+                if (!rtc) {
+                    LOG(LOG_ERROR, "Clock: Unable to read RTC");
+                    shellPrintf(PSTR("sync failed, RTC read error"));
+                    state = IDLE;
+                    break;
+                }
+                measure(rtc, ms);
+
+                // Wait for the host's next whole second, the RTC divider
+                // restarts when the seconds register is written
+                msSet = ms + (1000 - hostMsAt(ms) % 1000);
+                setTo = hostSecs + hostMsAt(msSet) / 1000;
+                state = WAIT_BOUNDARY;
+            } else if (millis() - msRequest > CLOCK_SYNC_TICK_TIMEOUT) {
+                LOG(LOG_ERROR, "Clock: RTC never ticked");
+                shellPrintf(PSTR("sync failed, RTC not running"));
+                state = IDLE;
+            }
+            break;
+
+        case WAIT_BOUNDARY:
+            if ((long)(msSet - millis()) > CLOCK_SYNC_SPIN_MS) break;
+            while ((long)(msSet - millis()) > 0);
+            apply();
+            state = IDLE;
+            break;
+
+        case IDLE:
+        default:
+            state = IDLE;
+            break;
+    }
+
+    return state != IDLE;
+}
+
+void ClockSync::invalidate()
+{
+    if (!settings.last_sync) return;
+    settings.last_sync = 0;
+    saveSettingsToEE();
+}
+
+void ClockSync::measure(time_t rtc, unsigned long msTick)
+{
+    offset = (int32_t)(rtc - hostSecs) * 1000 - (int32_t)hostMsAt(msTick);
+
+    // Last sync left the RTC spot on, so all of the offset is drift since then
+    if (settings.last_sync && hostSecs > settings.last_sync) {
+        interval = hostSecs - settings.last_sync;
+        driftPpb = (int64_t)offset * 1000000 / interval;
+    } else {
+        interval = 0;
+        driftPpb = 0;
+    }
+}
+
+void ClockSync::apply()
+{
+    // Nothing was applied, so keep the old time and the old sync as the
+    // base the next drift is measured from
+    if (RTC.set(setTo)) {
+        LOG(LOG_ERROR, "Clock: Unable to set RTC");
+        shellPrintf(PSTR("sync failed, RTC write error"));
+        return;
+    }
+    setTime(setTo);
+
+    int32_t mcuPpb = getMcuDriftPpb();
+    // Restart the millis() drift measurement from the new time
+    mcuStart = setTo;
+    sysUnsyncedTime = setTo;
+
+    trimAging();
+    settings.last_sync = setTo;
+    saveSettingsToEE();
+
+    LOG(LOG_DEBUG, "Clock: Synced, RTC was %ldms off after %lus", offset, interval);
+    shellPrintf(PSTR("synced offset %ldms interval %lus drift %ldppb mcu %ldppb"),
+        offset, interval, driftPpb, mcuPpb);
+}
+
+int32_t ClockSync::getMcuDriftPpb()
+{
+    time_t t = now();
+    if (t <= mcuStart) return 0;
+    return (int64_t)(int32_t)(sysUnsyncedTime - t) * 1000000000 / (int32_t)(t - mcuStart);
+}
+
+void ClockSync::trimAging()
+{
+    if (interval < CLOCK_TRIM_MIN_INTERVAL) return;
+
+    // What the RTC would have done untrimmed, the current aging already
+    // took aging * CLOCK_TRIM_PPB_PER_LSB out of the measured rate
+    int32_t natural = driftPpb + (int32_t)settings.aging * CLOCK_TRIM_PPB_PER_LSB;
+
+    if (!settings.samples) {
+        settings.natural_ppb = natural;
+    } else {
+        // Long intervals measure the rate best, so they get the most weight
+        settings.natural_ppb += (int64_t)(natural - settings.natural_ppb) * interval
+            / (interval + CLOCK_TRIM_TAU);
+    }
+    if (settings.samples < 0xFFFF) settings.samples++;
+
+    int32_t lsb = settings.natural_ppb >= 0
+        ? (settings.natural_ppb + CLOCK_TRIM_PPB_PER_LSB/2) / CLOCK_TRIM_PPB_PER_LSB
+        : (settings.natural_ppb - CLOCK_TRIM_PPB_PER_LSB/2) / CLOCK_TRIM_PPB_PER_LSB;
+    int8_t aging = constrain(lsb, -128, 127);
+
+    if (aging != settings.aging) {
+        LOG(LOG_DEBUG, "Clock: Aging offset %d -> %d (%ldppb)", settings.aging, aging,
+            settings.natural_ppb);
+        settings.aging = aging;
+        writeAging();
+    }
+}
+
+void ClockSync::writeAging()
+{
+    if (RTC.writeRTC(RTC_AGING, (byte)settings.aging)) {
+        LOG(LOG_ERROR, "Clock: Unable to write aging offset");
+        return;
+    }
+    // The new offset only takes effect after a temperature conversion
+    RTC.writeRTC(RTC_CONTROL, RTC.readRTC(RTC_CONTROL) | _BV(CONV));
+}
+
+bool ClockSync::loadSettingsFromEE()
+{
+    // Some crazy pointer casting to perform a memcpy so we can use the EEPROM macro
+    for (uint8_t i=0; i < CLOCK_SYNC_EE_SIZE; i++)
+    {
+        ((unsigned char*)&settings)[i] = EEPROM[eepromLoc + i];
+    }
+
+    return settings.crc == EEGenerateCrc(eepromLoc, CLOCK_SYNC_EE_SIZE - sizeof(settings.crc));
+}
+
+void ClockSync::saveSettingsToEE()
+{
+    // Write the data first so the crc can be taken over what is actually stored
+    for (uint8_t i=0; i < CLOCK_SYNC_EE_SIZE - sizeof(settings.crc); i++)
+    {
+        EEPROM.update(eepromLoc + i, ((unsigned char*)&settings)[i]);
+    }
+    settings.crc = EEGenerateCrc(eepromLoc, CLOCK_SYNC_EE_SIZE - sizeof(settings.crc));
+    for (uint8_t i=CLOCK_SYNC_EE_SIZE - sizeof(settings.crc); i < CLOCK_SYNC_EE_SIZE; i++)
+    {
+        EEPROM.update(eepromLoc + i, ((unsigned char*)&settings)[i]);
+    }
+}
@@ -0,0 +1,108 @@
+/*
+  ClockSync.h - Sets the RTC from a host clock on a second boundary,
+  measures how far it drifted since the last sync and trims the DS3232
+  aging offset to cancel that drift
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <Arduino.h>
+#include <DS3232RTC.h>
+#include "TimeLib.h"
+#include "EEPROM.h"
+#include "FeederUtils.h"
+
+// Give up if the RTC seconds register did not tick within this many ms
+#define CLOCK_SYNC_TICK_TIMEOUT 1100
+// Busy wait the last few ms before a second boundary instead of rescheduling
+#define CLOCK_SYNC_SPIN_MS 5
+#define CLOCK_SYNC_EE_SIZE (sizeof(EEClockSyncSettings))
+
+// Ignore syncs closer together than this, the offset is only good to a few ms
+#define CLOCK_TRIM_MIN_INTERVAL 86400UL
+// A sync this far from the last one moves the estimate half way to its measurement
+#define CLOCK_TRIM_TAU (7*86400UL)
+// One aging offset LSB is roughly 0.1ppm, positive slows the oscillator
+#define CLOCK_TRIM_PPB_PER_LSB 100
+
+// Make a struct so we can memcpy it out of EEPROM
+typedef struct EEClockSyncSettings
+{
+    // Host time of the last sync, 0 if never synced or set by hand since
+    time_t last_sync;
+    // Estimated drift with an aging offset of 0, in ppb
+    int32_t natural_ppb;
+    // Syncs that went into the estimate
+    uint16_t samples;
+    int8_t aging;
+    //crc MUST BE LAST ELEMENT IN STRUCT!
+    uint32_t crc;
+} EEClockSyncSettings;
+
+class ClockSync
+{
+    typedef enum SyncState
+    {
+        IDLE,
+        WAIT_TICK,
+        WAIT_BOUNDARY,
+    } SyncState;
+
+public:
+    ClockSync(uint16_t eepromLoc);
+
+    void begin();
+    // host_secs/host_ms is the host clock at the moment the request was received
+    void request(time_t host_secs, uint16_t host_ms);
+    // Call every couple of ms while a sync is pending, returns false once done
+    bool service();
+    bool isPending() { return state != IDLE; }
+    // The clock was set without measuring, the next sync can't tell drift
+    void invalidate();
+
+    // RTC error against the host at the last sync, in ms (positive is fast)
+    int32_t getOffset() { return offset; }
+    // RTC drift rate over the interval between the last two syncs, in ppb
+    int32_t getDriftPpb() { return driftPpb; }
+    uint32_t getInterval() { return interval; }
+    time_t getLastSync() { return settings.last_sync; }
+    int8_t getAging() { return settings.aging; }
+    int32_t getNaturalDriftPpb() { return settings.natural_ppb; }
+    uint16_t getTrimSamples() { return settings.samples; }
+    // Drift of the millis() clock against the RTC since begin() or the last sync, in ppb
+    int32_t getMcuDriftPpb();
+
+private:
+    const uint16_t eepromLoc;
+    EEClockSyncSettings settings;
+    SyncState state;
+
+    // millis() and host time when the request arrived
+    unsigned long msRequest;
+    time_t hostSecs;
+    uint16_t hostMs;
+
+    uint8_t rtcSecs;
+    unsigned long msSet;
+    time_t setTo;
+
+    int32_t offset;
+    int32_t driftPpb;
+    uint32_t interval;
+    // Time the millis() drift measurement started
+    time_t mcuStart;
+
+    // host time in ms past hostSecs at the given millis()
+    uint32_t hostMsAt(unsigned long ms) { return hostMs + (ms - msRequest); }
+    void measure(time_t rtc, unsigned long msTick);
+    void apply();
+    void trimAging();
+    void writeAging();
+
+    bool loadSettingsFromEE();
+    void saveSettingsToEE();
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "CrashLog.h"
+#include <avr/wdt.h>
+#include <string.h>
+
+// Both survive a watchdog reset (and usually a brown-out), so they must not
+// be zeroed by the C runtime
+static CrashLogRecord ring __attribute__((section(".noinit")));
+static uint8_t mcusr_mirror __attribute__((section(".noinit")));
+
+// Runs before the C runtime clears .bss, see the avr-libc wdt.h docs
+void saveMcusr() __attribute__((naked, used, section(".init3")));
+void saveMcusr()
+{
+    mcusr_mirror = MCUSR;
+    MCUSR = 0;
+    // A watchdog reset leaves the watchdog running on its shortest timeout
+    wdt_disable();
+}
+
+CrashLog::CrashLog(uint16_t eepromLoc)
+: eepromLoc(eepromLoc)
+{
+}
+
+void CrashLog::begin()
+{
+    // Anything else (power on, reset button, programmer) is not a crash
+    bool crashed = mcusr_mirror & (_BV(WDRF) | _BV(BORF));
+
+    if (crashed && ring.magic == CRASH_LOG_MAGIC) {
+        ring.mcusr = mcusr_mirror;
+        saveToEE();
+        report();
+    } else if (crashed) {
+        LOG(LOG_ERROR, "Crash: reset (MCUSR 0x%02X) but dispatch ring was lost", mcusr_mirror);
+    }
+
+    // Start a fresh ring for this boot
+    memset(&ring, 0, sizeof(ring));
+    ring.magic = CRASH_LOG_MAGIC;
+}
+
+void CrashLog::taskStart(uint8_t task_id)
+{
+    CrashLogEntry &e = ring.entries[ring.head];
+    e.task_id = task_id;
+    e.start_ms = millis();
+    e.duration = CRASH_LOG_RUNNING;
+}
+
+void CrashLog::taskEnd()
+{
+    CrashLogEntry &e = ring.entries[ring.head];
+    e.duration = MIN(millis() - e.start_ms, (uint32_t)CRASH_LOG_RUNNING - 1);
+    ring.head = (ring.head + 1) % CRASH_LOG_ENTRIES;
+}
+
+void CrashLog::capture(const uint8_t *sp, uint8_t task_id, uint8_t cp)
+{
+    // SP points at the next free byte, the interrupted PC was pushed right above it
+    // high byte last, so it reads back high byte first. The PC is a word address.
+    ring.sp = (uint16_t)sp;
+#if defined(__AVR_3_BYTE_PC__)
+    ring.ret_addr = (((uint32_t)sp[1] << 16) | ((uint32_t)sp[2] << 8) | sp[3]) << 1;
+#else
+    ring.ret_addr = (((uint32_t)sp[1] << 8) | sp[2]) << 1;
+#endif
+    ring.task_id = task_id;
+    ring.cp = cp;
+
+    // Don't wait for the second timeout, the ring is saved on the next boot
+    wdt_enable(WDTO_15MS);
+    for (;;);
+}
+
+bool CrashLog::report()
+{
+    CrashLogRecord rec;
+
+    for (uint8_t i=0; i < CRASH_LOG_EE_SIZE; i++)
+    {
+        ((unsigned char*)&rec)[i] = EEPROM[eepromLoc + i];
+    }
+
+    if (rec.magic != CRASH_LOG_MAGIC) {
+        LOG(LOG_DEBUG, "Crash: No crash recorded");
+        return false;
+    }
+
+    LOG(LOG_ERROR, "Crash: %s reset (MCUSR 0x%02X) in task_id: %u (cp: %u)",
+        rec.mcusr & _BV(WDRF) ? "Watchdog" : "Brown-out", rec.mcusr, rec.task_id, rec.cp);
+    LOG(LOG_ERROR, "Crash: PC 0x%05lX SP 0x%04X", rec.ret_addr, rec.sp);
+
+    // Oldest first, head is still unfinished if a task was running when it died
+    uint8_t start = rec.head + (rec.entries[rec.head].duration == CRASH_LOG_RUNNING);
+    for (uint8_t i=0, n=0; i < CRASH_LOG_ENTRIES; i++)
+    {
+        const CrashLogEntry &e = rec.entries[(start + i) % CRASH_LOG_ENTRIES];
+        if (!e.task_id) continue;
+
+        if (e.duration == CRASH_LOG_RUNNING) {
+            LOG(LOG_ERROR, "Crash: #%u task_id: %u at %lums never returned", ++n, e.task_id, e.start_ms);
+        } else {
+            LOG(LOG_ERROR, "Crash: #%u task_id: %u at %lums ran %ums", ++n, e.task_id, e.start_ms, e.duration);
+        }
+    }
+    return true;
+}
+
+void CrashLog::saveToEE()
+{
+    for (uint8_t i=0; i < CRASH_LOG_EE_SIZE; i++)
+    {
+        EEPROM.update(eepromLoc + i, ((unsigned char*)&ring)[i]);
+    }
+}
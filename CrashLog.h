@@ -0,0 +1,79 @@
+/*
+  CrashLog.h - Post-mortem record of the last task dispatches before a reset
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef CRASH_LOG_H
+#define CRASH_LOG_H
+
+#include <Arduino.h>
+#include "EEPROM.h"
+#include "FeederUtils.h"
+
+// How many task dispatches to remember (must fit in a byte)
+#define CRASH_LOG_ENTRIES 16
+// Duration of a dispatch that never returned
+#define CRASH_LOG_RUNNING 0xFFFF
+#define CRASH_LOG_MAGIC 0xC0DE
+#define CRASH_LOG_EE_SIZE (sizeof(CrashLogRecord))
+
+typedef struct CrashLogEntry
+{
+    // TaskScheduler id, 0 means the slot was never used
+    uint8_t task_id;
+    uint32_t start_ms;
+    uint16_t duration;
+} CrashLogEntry;
+
+// Same layout in .noinit RAM and in EEPROM
+typedef struct CrashLogRecord
+{
+    uint16_t magic;
+    uint8_t mcusr;
+    // Task and control point the watchdog ISR interrupted
+    uint8_t task_id;
+    uint8_t cp;
+    // Byte address of the interrupted instruction, 0 if the ISR never ran
+    uint32_t ret_addr;
+    uint16_t sp;
+    // Next slot to be written, the oldest entry once the ring has wrapped
+    uint8_t head;
+    CrashLogEntry entries[CRASH_LOG_ENTRIES];
+} CrashLogRecord;
+
+class CrashLog
+{
+public:
+    CrashLog(uint16_t eepromLoc);
+
+    // Call early in setup(), saves and reports the ring if the last reset was a crash
+    void begin();
+    void taskStart(uint8_t task_id);
+    void taskEnd();
+    // Called from the watchdog ISR by way of watchdogCapture(), never returns
+    void capture(const uint8_t *sp, uint8_t task_id, uint8_t cp) __attribute__((noreturn));
+    // Print the last crash saved in EEPROM
+    bool report();
+
+private:
+    const uint16_t eepromLoc;
+
+    void saveToEE();
+};
+
+// Marks a task dispatch in the crash log for as long as it is in scope
+class CrashLogTrace
+{
+public:
+    CrashLogTrace(CrashLog &log, uint8_t task_id) : log(log) { log.taskStart(task_id); }
+    ~CrashLogTrace() { log.taskEnd(); }
+
+private:
+    CrashLog &log;
+};
+
+// Put at the top of every task callback so the crash log sees the dispatch,
+// expects the sketch's crashLog and Scheduler ts
+#define TRACE_TASK() CrashLogTrace _trace(crashLog, (uint8_t)ts.currentTask().getId())
+
+#endif
@@ -0,0 +1,49 @@
+/*
+  DoorServo.h - A feed door servo, either on its own pin through the Servo
+  library or on a channel of the PCA9685, as its feedCompartDescs row says
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef DOOR_SERVO_H
+#define DOOR_SERVO_H
+
+#include "Arduino.h"
+#include "Servo.h"
+#include "Pca9685.h"
+#include "FeederConfig.h"
+
+extern Pca9685 servoExpander;
+
+class DoorServo
+{
+public:
+    DoorServo(const FeedCompartDesc &desc) : desc(desc), deg(0) {}
+
+    // The expander is started once for everyone in setup()
+    void attach()
+    {
+        if (desc.bus == FEED_SERVO_PIN) servo.attach(desc.servo);
+    }
+
+    // On the expander this only queues the angle, serviceFeeds() flushes
+    // all doors that moved in one go
+    void write(int16_t d)
+    {
+        deg = d;
+        if (desc.bus == FEED_SERVO_PIN) servo.write(d);
+        else servoExpander.setAngle(desc.servo, d);
+    }
+
+    int16_t read()
+    {
+        return desc.bus == FEED_SERVO_PIN ? servo.read() : deg;
+    }
+
+private:
+    const FeedCompartDesc &desc;
+    // Never attached on the expander, so it doesn't start Timer5
+    Servo servo;
+    int16_t deg;
+};
+
+#endif
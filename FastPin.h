@@ -0,0 +1,151 @@
+/*
+  FastPin.h - Compile time pin access for the ATmega2560, FastPin<N> resolves
+  the port, bit and PWM timer of Arduino pin N so each call is a couple of
+  instructions instead of digitalWrite()'s table lookups
+  Created by D. Aaron Wisner
+  Released into the public domain.
+
+  Rough cost at 16MHz, counted from the instructions each one generates:
+    digitalWrite()        ~55 cycles (pin table reads, PWM check, SREG save)
+    pinMode()             ~50 cycles
+    analogWrite()         ~80 cycles on Timer3
+    FastPin high()/low()    2 cycles on ports A-G (one SBI/CBI)
+                            6 cycles on ports H-L (LDS/ORI/STS with cli/sei)
+    FastPin toggle()        2 cycles on any port (a write to PINx)
+    FastPin pwm()         ~10 cycles (OCR store and COM bit set)
+*/
+#ifndef FAST_PIN_H
+#define FAST_PIN_H
+
+#include <Arduino.h>
+#include <util/atomic.h>
+
+// Ports A-G sit in the low I/O space where SBI/CBI reach, H-L need a read
+// modify write that an interrupt could split
+#define FAST_PIN_SBI_A 1
+#define FAST_PIN_SBI_B 1
+#define FAST_PIN_SBI_C 1
+#define FAST_PIN_SBI_D 1
+#define FAST_PIN_SBI_E 1
+#define FAST_PIN_SBI_F 1
+#define FAST_PIN_SBI_G 1
+#define FAST_PIN_SBI_H 0
+#define FAST_PIN_SBI_J 0
+#define FAST_PIN_SBI_K 0
+#define FAST_PIN_SBI_L 0
+
+// Only pins listed below exist, anything else fails to compile
+template<uint8_t Pin> struct FastPinTraits;
+template<uint8_t Pin> struct FastPwmTraits;
+
+#define FAST_PIN(pin, port, bit) \
+    template<> struct FastPinTraits<pin> \
+    { \
+        static volatile uint8_t &out() { return PORT##port; } \
+        static volatile uint8_t &in() { return PIN##port; } \
+        static volatile uint8_t &ddr() { return DDR##port; } \
+        enum { mask = _BV(bit), sbi = FAST_PIN_SBI_##port }; \
+    };
+
+#define FAST_PWM(pin, timer, channel) \
+    template<> struct FastPwmTraits<pin> \
+    { \
+        static volatile uint8_t &tccr() { return TCCR##timer##A; } \
+        static void duty(uint8_t d) { OCR##timer##channel = d; } \
+        enum { com = _BV(COM##timer##channel##1) }; \
+    };
+
+// Same mapping as the Mega's pins_arduino.h
+FAST_PIN(0, E, 0)  FAST_PIN(1, E, 1)  FAST_PIN(2, E, 4)  FAST_PIN(3, E, 5)
+FAST_PIN(4, G, 5)  FAST_PIN(5, E, 3)  FAST_PIN(6, H, 3)  FAST_PIN(7, H, 4)
+FAST_PIN(8, H, 5)  FAST_PIN(9, H, 6)  FAST_PIN(10, B, 4) FAST_PIN(11, B, 5)
+FAST_PIN(12, B, 6) FAST_PIN(13, B, 7) FAST_PIN(14, J, 1) FAST_PIN(15, J, 0)
+FAST_PIN(16, H, 1) FAST_PIN(17, H, 0) FAST_PIN(18, D, 3) FAST_PIN(19, D, 2)
+FAST_PIN(20, D, 1) FAST_PIN(21, D, 0) FAST_PIN(22, A, 0) FAST_PIN(23, A, 1)
+FAST_PIN(24, A, 2) FAST_PIN(25, A, 3) FAST_PIN(26, A, 4) FAST_PIN(27, A, 5)
+FAST_PIN(28, A, 6) FAST_PIN(29, A, 7) FAST_PIN(30, C, 7) FAST_PIN(31, C, 6)
+FAST_PIN(32, C, 5) FAST_PIN(33, C, 4) FAST_PIN(34, C, 3) FAST_PIN(35, C, 2)
+FAST_PIN(36, C, 1) FAST_PIN(37, C, 0) FAST_PIN(38, D, 7) FAST_PIN(39, G, 2)
+FAST_PIN(40, G, 1) FAST_PIN(41, G, 0) FAST_PIN(42, L, 7) FAST_PIN(43, L, 6)
+FAST_PIN(44, L, 5) FAST_PIN(45, L, 4) FAST_PIN(46, L, 3) FAST_PIN(47, L, 2)
+FAST_PIN(48, L, 1) FAST_PIN(49, L, 0) FAST_PIN(50, B, 3) FAST_PIN(51, B, 2)
+FAST_PIN(52, B, 1) FAST_PIN(53, B, 0) FAST_PIN(54, F, 0) FAST_PIN(55, F, 1)
+FAST_PIN(56, F, 2) FAST_PIN(57, F, 3) FAST_PIN(58, F, 4) FAST_PIN(59, F, 5)
+FAST_PIN(60, F, 6) FAST_PIN(61, F, 7) FAST_PIN(62, K, 0) FAST_PIN(63, K, 1)
+FAST_PIN(64, K, 2) FAST_PIN(65, K, 3) FAST_PIN(66, K, 4) FAST_PIN(67, K, 5)
+FAST_PIN(68, K, 6) FAST_PIN(69, K, 7)
+
+// Output compare channel behind each PWM pin, timers as init() sets them up
+FAST_PWM(2, 3, B)  FAST_PWM(3, 3, C)  FAST_PWM(4, 0, B)  FAST_PWM(5, 3, A)
+FAST_PWM(6, 4, A)  FAST_PWM(7, 4, B)  FAST_PWM(8, 4, C)  FAST_PWM(9, 2, B)
+FAST_PWM(10, 2, A) FAST_PWM(11, 1, A) FAST_PWM(12, 1, B) FAST_PWM(13, 0, A)
+FAST_PWM(44, 5, C) FAST_PWM(45, 5, B) FAST_PWM(46, 5, A)
+
+template<uint8_t Pin>
+class FastPin
+{
+    typedef FastPinTraits<Pin> P;
+
+public:
+    static void output() { setBits(P::ddr(), P::mask, P::sbi); }
+    static void input()
+    {
+        clearBits(P::ddr(), P::mask, P::sbi);
+        clearBits(P::out(), P::mask, P::sbi);
+    }
+    static void inputPullup()
+    {
+        clearBits(P::ddr(), P::mask, P::sbi);
+        setBits(P::out(), P::mask, P::sbi);
+    }
+
+    static void high() { setBits(P::out(), P::mask, P::sbi); }
+    static void low() { clearBits(P::out(), P::mask, P::sbi); }
+    static void write(bool v) { v ? high() : low(); }
+    // Writing a 1 to PINx flips the output, a single store on any port
+    static void toggle() { P::in() = P::mask; }
+    static bool read() { return P::in() & P::mask; }
+
+    // analogWrite() for a pin known to have a timer, 0 and 255 disconnect
+    // the timer and drive the pin like analogWrite() does
+    static void pwm(uint8_t duty)
+    {
+        typedef FastPwmTraits<Pin> T;
+
+        if (duty == 0 || duty == 255) {
+            clearBits(T::tccr(), T::com, false);
+            write(duty);
+        } else {
+            T::duty(duty);
+            setBits(T::tccr(), T::com, false);
+        }
+    }
+
+private:
+    // sbi is a constant, so only one branch is ever compiled in
+    static void setBits(volatile uint8_t &reg, uint8_t mask, bool sbi)
+    {
+        if (sbi) {
+            reg |= mask;
+        } else {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            {
+                reg |= mask;
+            }
+        }
+    }
+
+    static void clearBits(volatile uint8_t &reg, uint8_t mask, bool sbi)
+    {
+        if (sbi) {
+            reg &= ~mask;
+        } else {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+            {
+                reg &= ~mask;
+            }
+        }
+    }
+};
+
+#endif
@@ -7,7 +7,7 @@
 #define FEED_COMPART_H
 
 #include "Arduino.h"
-#include "Servo.h"
+#include "DoorServo.h"
 #include "TimeLib.h"
 #include <EEPROM.h>
 #include "FeederUtils.h"
@@ -17,6 +17,8 @@
 
 #define FEED_COMPART_EE_SIZE sizeof(EECompartSettings)
 
+extern SoundPlayer piezo;
+
 
 // Make a struct so we can memcpy it out of EEPROM
 typedef struct EECompartSettings
@@ -41,13 +43,11 @@ class FeedCompart
     } DoorState;
 
 private:
-    SoundPlayer &piezo;
-    const uint16_t servoPin;
+    // 1 based, also which row of feedCompartDescs this is
+    const uint8_t id;
+    const FeedCompartDesc &desc;
     const uint16_t eepromLoc;
-    // Servo open and close positions
-    Servo doorServo;
-    const int16_t openDeg, closeDeg;
-    uint8_t id;
+    DoorServo doorServo;
 
     EECompartSettings settings;
     DoorState currDoorState;
@@ -60,8 +60,9 @@ private:
     uint32_t generateCrc();
 
 public:
-    FeedCompart(SoundPlayer &piezo, uint16_t servoPin, uint16_t eepromLoc,
-        int16_t closeDeg, int16_t openDeg);
+    // Each one takes the next row of feedCompartDescs, so the only
+    // instance is feeds[NUM_FEEDS] in the sketch
+    FeedCompart();
 
     void enable();
     void disable();
@@ -71,8 +72,12 @@ public:
     void unlockFeed() { lock = false; }
 
     // getters
-    Servo &getServo();
+    DoorServo &getServo();
     bool isEnabled();
+    bool isDoorOpen() { return currDoorState != CLOSED; }
+    // When the door opens next, 0 if the feed is off
+    time_t getNextOpen();
+    const char *getName() { return desc.name; }
 
     uint8_t getWeekDay() { return settings.Wday; }
     uint8_t getHour() { return settings.Hour; }
@@ -89,9 +94,9 @@ public:
 //Default it to zero
 uint8_t FeedCompart::_id_counter = 0;
 
-FeedCompart::FeedCompart(SoundPlayer &piezo, uint16_t servoPin, uint16_t eepromLoc, int16_t closeDeg, int16_t openDeg)
-: piezo(piezo), servoPin(servoPin), eepromLoc(eepromLoc), doorServo(),
-openDeg(openDeg), closeDeg(closeDeg), id(++_id_counter)
+FeedCompart::FeedCompart()
+: id(++_id_counter), desc(feedCompartDescs[id - 1]),
+eepromLoc(EEPROM_FEEDER_SETTING_LOC + desc.slot*FEED_COMPART_EE_SIZE), doorServo(desc)
 {
     lock = false;
     currDoorState = CLOSED;
@@ -101,7 +106,7 @@ openDeg(openDeg), closeDeg(closeDeg), id(++_id_counter)
 /*
 FeedCompart::~FeedCompart()
 {
-    doorServo.write(closeDeg);
+    doorServo.write(desc.closeDeg);
     doorServo.detach();
 }
 */
@@ -124,9 +129,10 @@ void FeedCompart::begin()
 
     }
 
-    doorServo.attach(servoPin);
-    doorServo.write(closeDeg);
-    LOG(LOG_DEBUG, "Feed Door %d: Servo attached to pin %d", id, servoPin);
+    doorServo.attach();
+    doorServo.write(desc.closeDeg);
+    LOG(LOG_DEBUG, "Feed Door %d: Servo on %s %d", id,
+        desc.bus == FEED_SERVO_PIN ? "pin" : "PCA9685 channel", desc.servo);
 
     // No idea why I'm having to do this...
     char tmp[5];
@@ -140,16 +146,16 @@ void FeedCompart::begin()
 
 void FeedCompart::service()
 {
-    time_t curr = now();
+    const timeSnapshot_t &snap = timeSnapshot();
+    time_t curr = snap.Time;
 
         // Run the state machine for the door
         switch(currDoorState)
         {
             case CLOSED:
-                if ((settings.enabled && !lock && weekday(curr) == settings.Wday)) {
+                if ((settings.enabled && !lock && snap.Elements.Wday == settings.Wday)) {
                     // figure out the time_t the door should open
-                    tmElements_t to_open;
-                    breakTime(curr, to_open);
+                    tmElements_t to_open = snap.Elements;
                     // We know the day is correct, so just fil in the rest
                     to_open.Hour = settings.Hour;
                     to_open.Minute = settings.Minute;
@@ -166,14 +172,14 @@ void FeedCompart::service()
 
                     }
                 }
-                doorServo.write(closeDeg);
+                doorServo.write(desc.closeDeg);
                 break;
 
             case OPENING:
 
-                if (doorServo.read() != openDeg) {
+                if (doorServo.read() != desc.openDeg) {
                     doorServo.write(map(constrain(millis() - msStateChange, 0, DOOR_SPEED), 0,
-                        DOOR_SPEED, closeDeg, openDeg));
+                        DOOR_SPEED, desc.closeDeg, desc.openDeg));
                 } else {
                     msStateChange = millis();
                     LOG(LOG_DEBUG, "Feeder %d opened!", id);
@@ -188,13 +194,13 @@ void FeedCompart::service()
                     piezo.play(&SoundPlayer::close);
                     LOG(LOG_DEBUG, "Feeder %d closing!", id);
                 }
-                doorServo.write(openDeg);
+                doorServo.write(desc.openDeg);
                 break;
 
             case CLOSING:
-                if (doorServo.read() != closeDeg) {
+                if (doorServo.read() != desc.closeDeg) {
                     doorServo.write(map(constrain(millis() - msStateChange, 0, DOOR_SPEED), 0,
-                        DOOR_SPEED, openDeg, closeDeg));
+                        DOOR_SPEED, desc.openDeg, desc.closeDeg));
                 } else {
                     msStateChange = millis();
                     LOG(LOG_DEBUG, "Feeder %d closed!", id);
@@ -208,12 +214,29 @@ void FeedCompart::service()
             default:
                 LOG(LOG_ERROR, "Feeder %d state machine in invalid state!", id);
                 currDoorState = CLOSED;
-                doorServo.write(closeDeg);
+                doorServo.write(desc.closeDeg);
                 break;
         }
 
 }
 
+time_t FeedCompart::getNextOpen()
+{
+    const timeSnapshot_t &snap = timeSnapshot();
+
+    if (!settings.enabled) return 0;
+    if (currDoorState != CLOSED) return snap.Time;
+
+    tmElements_t to_open = snap.Elements;
+    to_open.Hour = settings.Hour;
+    to_open.Minute = settings.Minute;
+    to_open.Second = 0;
+    time_t set = makeTime(to_open) + ((settings.Wday + 7 - snap.Elements.Wday) % 7) * SECS_PER_DAY;
+    // Past this week's window, service() will wait for next week
+    if (snap.Time >= set + 60*DOOR_OPEN_TIME) set += SECS_PER_WEEK;
+    return set;
+}
+
 void FeedCompart::enable()
 {
     settings.enabled = true;
@@ -224,7 +247,7 @@ void FeedCompart::disable()
     settings.enabled = false;
 }
 
-Servo &FeedCompart::getServo()
+DoorServo &FeedCompart::getServo()
 {
     return doorServo;
 }
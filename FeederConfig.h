@@ -21,14 +21,35 @@ byte arrowChar[8] = {
 
 #define RTC_SYNC_INTERVAL 30
 
+// Nothing allocates at runtime, NoHeap.h turns any malloc() or new that
+// creeps back in into a link error. Comment out to allow the heap again,
+// only the C RingBuf benchmark needs it.
+#define NO_HEAP
+// Uncomment to check the trap still fires, the build must then fail to link
+// with "undefined reference to `heap_used_in_NO_HEAP_build'"
+// #define NO_HEAP_LINK_TEST
+
 // uncomment to disable wifi
 #define ENABLE_WIFI
 #define SSID        "KittyFeeder " VERSION
 
 #define PASSWORD    "thisIsPass"
-
-// ms for button debounce
-#define BTN_DEBOUNCE_TIME 5
+// Seconds the ESP8266 lets a link sit idle before closing it
+#define WIFI_SERVER_TIMEOUT 10
+// ms between keep alive comments on /events, well inside the timeout above
+#define SSE_KEEPALIVE_TIME 5000
+// /events links held open at once, each one keeps a link and a send per change busy
+#define WIFI_MAX_SSE_LINKS 2
+// The ESP8266 starts at 115200 and is switched to this once the AP is up,
+// 500000 is exact on both the 16MHz AVR and the 80MHz ESP8266 divider.
+// Only with RTS/CTS wired, without them nothing stops the ESP8266 while
+// we are busy and the RX ring fills 4x faster than at 115200.
+#define WIFI_BAUD 500000
+// Pins going to the ESP8266 CTS and RTS, the ESP-01 does not break them out
+#define WIFI_RTS_PIN WIFI_UART_NO_PIN
+#define WIFI_CTS_PIN WIFI_UART_NO_PIN
+
+// Buttons are debounced over 4 ticks of the ~1ms Timer0 compare B interrupt
 
 // ms to open and close door
 #define DOOR_SPEED 3000
@@ -38,23 +59,88 @@ byte arrowChar[8] = {
 // Cooler setting constrants
 #define MAX_COOLER_SET_TEMP 80
 #define MIN_COOLER_SET_TEMP 35
+// Degrees over the set temp the food may warm to while the next feed is
+// far off, the cooler starts in time to be at the set temp when the door
+// opens. 0 holds the set temp whenever a feed is on.
+#define COOLER_MAX_FLOAT 10
+// ms between cooler updates, each one reads the DS3232's temperature
+#define TEMP_FAST_INTERVAL 500
+// ms between DHT22 reads, at least 2000. They block for ~5ms and are only
+// used for humidity and to calibrate the DS3232 reading.
+#define TEMP_SLOW_INTERVAL 10000
+
+// Feed compartments, one row each. Menus, EEPROM, the shell and the web
+// pages are all built from this table, add rows for a bigger feeder.
+// slot is where a compartment's settings sit in EEPROM, keep it the same
+// when moving rows around so the schedules stay with their doors.
+// servo is a pin for FEED_SERVO_PIN or a channel for FEED_SERVO_PCA9685.
+typedef enum FeedServoBus
+{
+    // Servo library, Timer5 interrupts for every pulse
+    FEED_SERVO_PIN,
+    // Channel on the PCA9685 at SERVO_EXPANDER_ADDR, no interrupts at all
+    FEED_SERVO_PCA9685,
+} FeedServoBus;
+
+typedef struct FeedCompartDesc
+{
+    const char *name;
+    uint8_t servo;
+    FeedServoBus bus;
+    int16_t closeDeg, openDeg;
+    uint8_t slot;
+} FeedCompartDesc;
+
+constexpr FeedCompartDesc feedCompartDescs[] = {
+    // name           servo  bus             close  open  slot
+    { "Left Feeder",  8,     FEED_SERVO_PIN, 20,    110,  0 },
+    { "Right Feeder", 9,     FEED_SERVO_PIN, 175,   80,   1 },
+};
+
+#define NUM_FEEDS (sizeof(feedCompartDescs) / sizeof(feedCompartDescs[0]))
+
+// EEPROM slots to reserve, one past the highest slot in the table
+constexpr uint8_t feedEESlots(uint8_t i = 0, uint8_t n = 0)
+{
+    return i == NUM_FEEDS ? n : feedEESlots(i + 1,
+        feedCompartDescs[i].slot >= n ? feedCompartDescs[i].slot + 1 : n);
+}
 
-// Servo position settings
-#define SERVO1_OPEN 110
-#define SERVO1_CLOSE 20
-#define SERVO2_OPEN 80
-#define SERVO2_CLOSE 175
+constexpr bool feedSlotFree(uint8_t slot, uint8_t i)
+{
+    return i == NUM_FEEDS || (feedCompartDescs[i].slot != slot && feedSlotFree(slot, i + 1));
+}
+
+constexpr bool feedSlotsUnique(uint8_t i = 0)
+{
+    return i == NUM_FEEDS || (feedSlotFree(feedCompartDescs[i].slot, i + 1) && feedSlotsUnique(i + 1));
+}
+
+static_assert(feedSlotsUnique(), "Two feed compartments share an EEPROM slot");
+
+// The expander is only set up and flushed when something is on it
+constexpr bool feedUsesExpander(uint8_t i = 0)
+{
+    return i < NUM_FEEDS && (feedCompartDescs[i].bus == FEED_SERVO_PCA9685 || feedUsesExpander(i + 1));
+}
+// Door states go out as a bitmask and the idle screen numbers them 1-8
+static_assert(NUM_FEEDS >= 1 && NUM_FEEDS <= 8, "Need between 1 and 8 feed compartments");
 
 // LCD Constants
 #define LCD_ROWS 2
+// CGRAM slot arrowChar is loaded into
+#define ARROW_CHAR ((uint8_t)0)
 // How many ms to redraw menu automatically if no button pressed
 #define LCD_AUTO_REDRAW 1000
+// Shortest ms between two LCD frames, presses inside one frame are drawn once
+#define LCD_FRAME_TIME 50
 
 // EEPROM SETTING SAVE LOCATION
 #define EEPROM_FEEDER_SETTING_LOC 100
-#define EEPROM_COOLER_SETTINGS_LOC (EEPROM_FEEDER_SETTING_LOC + 2*FEED_COMPART_EE_SIZE)
-// Requires two bytes from this index
-#define EEPROM_WDT_DEBUG_LOC (EEPROM.length()-1-2)
+#define EEPROM_COOLER_SETTINGS_LOC (EEPROM_FEEDER_SETTING_LOC + feedEESlots()*FEED_COMPART_EE_SIZE)
+#define EEPROM_CLOCK_SYNC_LOC (EEPROM_COOLER_SETTINGS_LOC + THERMO_COOLER_EE_SIZE)
+// Last crash record, at the very end of the EEPROM
+#define EEPROM_CRASH_LOG_LOC (EEPROM.length()-CRASH_LOG_EE_SIZE)
 
 
 /* DEVICE PIN CONFIGURATION */
@@ -72,21 +158,27 @@ byte arrowChar[8] = {
 #define PIEZO_PIN1 11
 #define PIEZO_PIN2 10
 
-#define SERVO1_PIN 8
-
-#define SERVO2_PIN 9
+// Servo pins are in feedCompartDescs above, the PCA9685 is on the I2C bus
+// with the RTC (SDA 20, SCL 21)
+#define SERVO_EXPANDER_ADDR 0x40
 
+// PeltierDriver runs Timer3 itself and only drives OC3A, so this can't move
 #define THERMO_COOLER_PIN 5
+// ms for the Peltier to ramp from off to full on, the module never sees a step
+#define PELTIER_RAMP_MS 2000
 
 // Give it an interrupt pin, if I ever change to an ainterrupt lib
 #define DHTPIN 3
 #define DHTTYPE DHT22   // DHT 22  (AM2302), AM2321
 
-//define buttons
+//define buttons, all of them have to be on PORTK (A8-A15)
 #define BTN_PIN_RIGHT A8
 #define BTN_PIN_UP A9
 #define BTN_PIN_DOWN A10
 #define BTN_PIN_LEFT A11
 #define BTN_PIN_SELECT A12
+#define BTN_BIT(pin) _BV((pin) - A8)
+#define BTN_MASK (BTN_BIT(BTN_PIN_RIGHT) | BTN_BIT(BTN_PIN_UP) | BTN_BIT(BTN_PIN_DOWN) \
+    | BTN_BIT(BTN_PIN_LEFT) | BTN_BIT(BTN_PIN_SELECT))
 
 #endif
@@ -1,4 +1,5 @@
 #include "FeederUtils.h"
+#include <stdarg.h>
 
 uint32_t EEGenerateCrc(uint16_t start, uint16_t num_bytes)
 {
@@ -24,6 +25,28 @@ uint16_t createDebugString(char *buf, uint16_t buf_size, uint16_t line, bool err
     PROGMEM char *debug = "DEBUG (%s %d %d:%d:%d)(%d): ";
     PROGMEM char *err = "ERROR (%s %d %d:%d:%d)(%d): ";
 
+    const tmElements_t &tm = timeSnapshot().Elements;
     return MIN(buf_size, snprintf(buf, buf_size, error == LOG_DEBUG ? debug : err,
-        monthShortStr(month()), day(), hour(), minute(), second(), line));
+        monthShortStr(tm.Month), tm.Day, tm.Hour, tm.Minute, tm.Second, line));
+}
+
+// Bytes between the top of the heap (or .bss if it was never used) and the stack
+int freeMemory()
+{
+    // Same types as avr-libc and NoHeap.h
+    extern char __heap_start, *__brkval;
+    char top;
+    return &top - (__brkval ? __brkval : &__heap_start);
+}
+
+// Prints one line of serial shell output, format string must be in flash
+void shellPrintf(const char *fmt, ...)
+{
+    char buf[SHELL_OUT_SIZE];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf_P(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    Serial.println(buf);
 }
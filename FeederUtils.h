@@ -7,6 +7,8 @@
 #include <avr/pgmspace.h>
 
 #define ERROR_BUF_SIZE 90
+// Longest line shellPrintf() will print
+#define SHELL_OUT_SIZE 80
 
 #define MIN(a,b) (((a)<(b))?(a):(b))
 #define MAX(a,b) (((a)>(b))?(a):(b))
@@ -39,8 +41,12 @@ typedef struct FeedMenuStorage
   const uint8_t *arrow_locs;
   uint8_t num_locs;
   uint8_t curr_loc;
+  // feeds[] entry the menu edits
+  uint8_t index;
 } FeedMenuStorage;
 
 uint32_t EEGenerateCrc(uint16_t start, uint16_t num_bytes);
 uint16_t createDebugString(char *buf, uint16_t buf_size, uint16_t line, bool error);
+int freeMemory();
+void shellPrintf(const char *fmt, ...);
 #endif
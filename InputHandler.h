@@ -2,7 +2,7 @@
 #define INPUT_HANDLER_H
 
 #include "Arduino.h"
-#include "Button.h"
+#include "ButtonBank.h"
 #include "MenuSystem.h"
 #include "StorageMenu.h"
 #include "FeederUtils.h"
@@ -14,39 +14,44 @@ typedef enum InputHandler
     IdleMenuHandler,
     StaticMenuHandler,
     MenuNavigatorHandler,
-    Feeder1MenuHandler,
-    Feeder2MenuHandler,
+    FeederMenuHandler,
     TemperatureMenuHandler,
     NullHandler
 } InputHandler;
 
 
 // Is there a better way to do this?
-extern Button bRight;
-extern Button bUp;
-extern Button bDown;
-extern Button bLeft;
-extern Button bSelect;
+extern BankButton bRight;
+extern BankButton bUp;
+extern BankButton bDown;
+extern BankButton bLeft;
+extern BankButton bSelect;
 
 extern FeedCompart feeds[];
 extern ThermoCooler cooler;
 extern MenuSystem ms;
 extern InputHandler currHandler;
+extern bool lcdDirty;
+extern CrashLog crashLog;
+extern Scheduler ts;
 
 
 extern void serviceButtons();
 extern bool anyBtnWasPressed();
 extern bool anyBtnIsPressed();
+extern InputHandler menuHandler(Menu const *menu);
 
 void inputHandler();
+void uiChanged();
 void menuNavigatorHandler();
-void feederMenuHandler(const unsigned char index);
+void feederMenuHandler();
+FeedMenuStorage *currFeedMenu();
 
 void temperatureMenuHandler();
 
 void inputHandler()
 {
-    static unsigned long long redraw_ts=0;
+    TRACE_TASK();
 
     serviceButtons();
     // which input handler do we use?
@@ -62,12 +67,8 @@ void inputHandler()
             menuNavigatorHandler();
             break;
 
-        case Feeder1MenuHandler:
-            feederMenuHandler(0);
-            break;
-
-        case Feeder2MenuHandler:
-            feederMenuHandler(1);
+        case FeederMenuHandler:
+            feederMenuHandler();
             break;
 
         case TemperatureMenuHandler:
@@ -80,10 +81,32 @@ void inputHandler()
         default:
             break;
     }
-    if (anyBtnWasPressed() || millis() >= redraw_ts) {
-        ms.display();
-        redraw_ts = millis() + LCD_AUTO_REDRAW;
+    // Drawn by renderLcd() at its own pace, not once per press
+    if (anyBtnWasPressed()) uiChanged();
+}
+
+// Call after anything that changes the current menu or what it shows.
+// Picks the input handler for the new screen, the display callbacks only draw.
+void uiChanged()
+{
+    // The feed whose time is being edited, it doesn't run until it's done
+    static FeedCompart *editing = NULL;
+    InputHandler next = menuHandler(ms.get_current_menu());
+    FeedCompart *edit = next == FeederMenuHandler ? &feeds[currFeedMenu()->index] : NULL;
+
+    if (edit != editing) {
+        if (editing) {
+            editing->unlockFeed();
+            LOG(LOG_DEBUG, "Exiting feed menu, reenabling feed servicing");
+        }
+        if (edit) {
+            edit->lockFeed();
+            LOG(LOG_DEBUG, "Entering feed menu, disabling feed servicing");
+        }
+        editing = edit;
     }
+    currHandler = next;
+    lcdDirty = true;
 }
 
 void menuNavigatorHandler()
@@ -94,11 +117,18 @@ void menuNavigatorHandler()
     else if (bDown.wasPressed()) ms.next();
 }
 
-// Index in feeds array of current item
-void feederMenuHandler(const unsigned char index)
+// Only valid while a feed menu is the current one
+FeedMenuStorage *currFeedMenu()
+{
+    StorageMenu *sm = (StorageMenu *)ms.get_current_menu();
+    return (FeedMenuStorage *)sm->getStorage();
+}
+
+// The menu's storage says which feed it edits
+void feederMenuHandler()
 {
-    StorageMenu *sm= (StorageMenu *)ms.get_current_menu();
-    FeedMenuStorage *stor = (FeedMenuStorage *)sm->getStorage();
+    FeedMenuStorage *stor = currFeedMenu();
+    const uint8_t index = stor->index;
     uint8_t tmp = 0;
 
 
@@ -110,10 +140,8 @@ void feederMenuHandler(const unsigned char index)
         } else {
             stor->curr_loc = 0;
             feeds[index].saveSettingsToEE();
+            // uiChanged() reenables feed servicing
             ms.back();
-            // Reenable feed servicing
-             feeds[index].unlockFeed();
-             LOG(LOG_DEBUG, "Exiting feed menu, reenabling feed servicing");
             return;
         }
     } else if (bLeft.wasPressed()) {
@@ -122,10 +150,8 @@ void feederMenuHandler(const unsigned char index)
         } else {
             stor->curr_loc = 0;
             feeds[index].saveSettingsToEE();
+            // uiChanged() reenables feed servicing
             ms.back();
-            // Reenable feed servicing
-             feeds[index].unlockFeed();
-             LOG(LOG_DEBUG, "Exiting feed menu, reenabling feed servicing");
             return;
         }
     }
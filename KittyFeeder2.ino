@@ -8,15 +8,26 @@
 #include <TaskScheduler.h>
 #include "DHT.h"
 #include "FeedCompart.h"
+#include "Pca9685.h"
 #include "ThermoCooler.h"
+#include "TempSensor.h"
+#include "PeltierDriver.h"
+#include "CrashLog.h"
+#include "ClockSync.h"
 #include "InputHandler.h"
-#include "Button.h"
+#include "SerialShell.h"
+#include "Bench.h"
+#include "ButtonBank.h"
 #include <MenuSystem.h>
 #include "StorageMenu.h"
+#include "MenuDisplay.h"
 // Have to use this library due to conflicts with Servo interrupts
 #include "SoundPlayer.h"
+#include "FastPin.h"
 #include <LiquidCrystal.h>
-#include "ESP8266.h"
+#include "WifiServer.h"
+#include "WifiUart.h"
+#include "WebAssets.h"
 
 char err_buf[ERROR_BUF_SIZE];
 uint16_t err_remain;
@@ -24,7 +35,9 @@ uint16_t err_remain;
 
 ///// ALL THE DEVICE CONFIGS COME FROM HERE
 #include "FeederConfig.h"
-#define ARROW_CHAR ((uint8_t)0)
+#ifdef NO_HEAP
+#include "NoHeap.h"
+#endif
 
 // Locations for the arrows on the feed menus
 const uint8_t feedMenuArrowLocs[] = {0, 4, 8, 11};
@@ -34,14 +47,24 @@ void wdtService(); bool wdtOn(); void wdtOff();
 
 void serviceFeeds();
 void serviceCooler();
+long secsToNextFeed();
 void serviceSerial();
+void serviceClockSync();
 void servicePiezo();
 void serviceWifi();
+void renderLcd();
+int16_t statusPage(WifiLink &link, char *buf, uint16_t size);
+int16_t assetPage(WifiLink &link, char *buf, uint16_t size);
+int16_t eventsPage(WifiLink &link, char *buf, uint16_t size);
+void updateTelemetry();
 
 void enableWifi();
 void disableWifi();
 
-double getTemp();
+bool getTemp(double &temp, double &sigma);
+double getFastTemp();
+bool getSlowTemp(double &temp, double &humidity);
+void setCoolerPwm(uint8_t duty);
 void inputHandler();
 
 bool anyBtnWasPressed();
@@ -49,59 +72,61 @@ bool anyBtnIsPressed();
 
 void displayIdleMenu(Menu *cp_menu);
 void displayMenu(Menu *cp_menu);
-void displayFeed1(Menu *cp_menu);
-void displayFeed2(Menu *cp_menu);
+void displayFeed(Menu *cp_menu);
 void displayTemp(Menu *cp_menu);
 void displaySystemInfo(Menu *cp_menu);
 void displayClockMenu(Menu *cp_menu);
 void displayWifiMenu(Menu *cp_menu);
 
-// Helper function
-void displayFeed(const uint8_t index, StorageMenu *cp_menu);
-
 uint8_t calcLcdTitleCenter(const char* str);
 
-//wifi
-ESP8266 wifi(Serial1, 115200);
+//wifi, webServer sets up the AP with plain AT commands and serves it after that.
+// wifiSerial takes over USART1 from Serial1.
+WifiUart wifiSerial(WIFI_RTS_PIN, WIFI_CTS_PIN);
+WifiServer webServer(wifiSerial);
+// Requests are matched against this in order, anything else gets a 404
+const WifiRoute webRoutes[] PROGMEM = {
+  { "GET", "/", &assetPage },
+  { "GET", "/app.css", &assetPage },
+  { "GET", "/app.js", &assetPage },
+  { "GET", "/status", &statusPage },
+  { "GET", "/events", &eventsPage, WIFI_MAX_SSE_LINKS },
+};
 //piezo
-SoundPlayer piezo(PIEZO_PIN1, PIEZO_PIN2);
+SoundPlayer piezo;
 // Current input handler
 InputHandler currHandler;
-//buttons
-Button bRight(BTN_PIN_RIGHT, true, true, BTN_DEBOUNCE_TIME);
-Button bUp(BTN_PIN_UP, true, true, BTN_DEBOUNCE_TIME);
-Button bDown(BTN_PIN_DOWN, true, true, BTN_DEBOUNCE_TIME);
-Button bLeft(BTN_PIN_LEFT, true, true, BTN_DEBOUNCE_TIME);
-Button bSelect(BTN_PIN_SELECT, true, true, BTN_DEBOUNCE_TIME);
-
-//put them into array to service laver
-Button *const bAll[] = { &bSelect, &bLeft, &bRight, &bUp, &bDown };
-
-// Declare all your feed compartments and link them with servos
-FeedCompart feeds[] = {
-  FeedCompart(piezo, SERVO1_PIN, EEPROM_FEEDER_SETTING_LOC, SERVO1_CLOSE, SERVO1_OPEN),
-  FeedCompart(piezo, SERVO2_PIN, EEPROM_FEEDER_SETTING_LOC + FEED_COMPART_EE_SIZE, SERVO2_CLOSE, SERVO2_OPEN),
-};
-
-ThermoCooler cooler(THERMO_COOLER_PIN, &getTemp, EEPROM_COOLER_SETTINGS_LOC);
+// Something on the LCD changed, renderLcd() draws it on its next frame
+bool lcdDirty = true;
+//buttons, debounced together from the Timer0 compare B tick
+ButtonBank buttons(&PINK, BTN_MASK);
+BankButton bRight(buttons, BTN_BIT(BTN_PIN_RIGHT));
+BankButton bUp(buttons, BTN_BIT(BTN_PIN_UP));
+BankButton bDown(buttons, BTN_BIT(BTN_PIN_DOWN));
+BankButton bLeft(buttons, BTN_BIT(BTN_PIN_LEFT));
+BankButton bSelect(buttons, BTN_BIT(BTN_PIN_SELECT));
+
+// Door servos on FEED_SERVO_PCA9685 rows
+Pca9685 servoExpander(SERVO_EXPANDER_ADDR);
+// One per row of feedCompartDescs in FeederConfig.h, built in table order
+FeedCompart feeds[NUM_FEEDS];
+
+// DS3232 die temperature for the cooler, kept honest by the DHT22
+TempSensor temps(&getFastTemp, &getSlowTemp, TEMP_SLOW_INTERVAL);
+// Timer3 at 25kHz on THERMO_COOLER_PIN, ramped from the Timer0 compare B tick
+PeltierDriver peltier(PELTIER_RAMP_MS);
+ThermoCooler cooler(&setCoolerPwm, &getTemp, EEPROM_COOLER_SETTINGS_LOC);
+CrashLog crashLog(EEPROM_CRASH_LOG_LOC);
+ClockSync clockSync(EEPROM_CLOCK_SYNC_LOC);
 
 // Menu variables
 MenuSystem ms;
 Menu mm_idle("Idle Menu", &displayIdleMenu);
 Menu mm("KittyFeeder" VERSION, &displayMenu);
 Menu mm_feeds("Feeders", &displayMenu);
-// Menu storage struct to track state
-FeedMenuStorage fm1 = {.arrow_locs = feedMenuArrowLocs,
-                       .num_locs = sizeof(feedMenuArrowLocs) / sizeof(feedMenuArrowLocs[0]),
-                       .curr_loc = 0
-                      },
-                fm2 = {.arrow_locs = feedMenuArrowLocs,
-                       .num_locs = sizeof(feedMenuArrowLocs) / sizeof(feedMenuArrowLocs[0]),
-                       .curr_loc = 0
-                      };
-
-StorageMenu feeds_feed1("Left Feeder", &fm1, sizeof(fm1), &displayFeed1);
-StorageMenu feeds_feed2("Right Feeder", &fm2, sizeof(fm2), &displayFeed2);
+// A menu per feed, named and hooked up to its storage in setup()
+FeedMenuStorage feedMenuStor[NUM_FEEDS];
+StorageMenu feedMenus[NUM_FEEDS];
 
 Menu mm_temp("Cooler", &displayTemp);
 Menu mm_clock("Clock", &displayClockMenu);
@@ -115,11 +140,18 @@ Scheduler ts;
 //////// TASKS /////////////
 Task tWatchdog(500, TASK_FOREVER, &wdtService, &ts, false, &wdtOn, &wdtOff);
 Task tServiceFeeds(TASK_IMMEDIATE, TASK_FOREVER, &serviceFeeds, &ts, true);
-Task tServiceCooler(2000, TASK_FOREVER, &serviceCooler, &ts, true);
+Task tServiceCooler(TEMP_FAST_INTERVAL, TASK_FOREVER, &serviceCooler, &ts, true);
 Task tServiceInput(TASK_IMMEDIATE, TASK_FOREVER, &inputHandler, &ts, true);
-Task tServiceSerial(1, TASK_FOREVER, &serviceSerial, &ts, true);
+Task tRenderLcd(LCD_FRAME_TIME, TASK_FOREVER, &renderLcd, &ts, true);
+// Drains the whole RX buffer each pass, 4ms is well under the time to fill 64 bytes at 115200
+Task tServiceSerial(4, TASK_FOREVER, &serviceSerial, &ts, true);
+// Only enabled while a serial clock sync is waiting on a second boundary
+Task tClockSync(2, TASK_FOREVER, &serviceClockSync, &ts, false);
 Task tServicePiezo(TASK_IMMEDIATE, TASK_FOREVER, &servicePiezo, &ts, true);
-Task tServiceWifi(500, TASK_FOREVER, &serviceWifi, &ts, true); // dont run as often because too exspensive with cpu time
+// Never blocks. WifiUart's 255 byte RX ring takes 22ms to fill at 115200
+// and RTS holds the ESP8266 off at WIFI_BAUD, so 4ms is about keeping the
+// TX ring fed at 500000 (5ms to drain) and turning AT replies around.
+Task tServiceWifi(4, TASK_FOREVER, &serviceWifi, &ts, true);
 
 DHT dht(DHTPIN, DHTTYPE);
 
@@ -136,15 +168,12 @@ void setup() {
     LOG(LOG_ERROR, "Unable to sync with the RTC");
   else
     LOG(LOG_DEBUG, "RTC has set the system time");
+  clockSync.begin();
 
-  if (EEPROM.read(EEPROM_WDT_DEBUG_LOC))
-  {
-    LOG(LOG_ERROR, "Watchdog triggered system reset for task_id: %u (cp: %d)",
-        EEPROM.read(EEPROM_WDT_DEBUG_LOC), EEPROM.read(EEPROM_WDT_DEBUG_LOC + 1));
-    EEPROM.write(EEPROM_WDT_DEBUG_LOC, 0);
-    EEPROM.write(EEPROM_WDT_DEBUG_LOC + 1, 0);
 
-  }
+  // Report the task dispatches leading up to a watchdog or brown-out reset
+  crashLog.begin();
+
   //Reset Wifi
   disableWifi();
   #ifdef ENABLE_WIFI
@@ -152,19 +181,39 @@ void setup() {
   #endif
   
   // Begin KittyFeeder objects
-  for (uint8_t i = 0; i < sizeof(feeds) / sizeof(feeds[0]); i++)
+  if (feedUsesExpander()) servoExpander.begin();
+  for (uint8_t i = 0; i < NUM_FEEDS; i++)
   {
     feeds[i].begin();
   }
+  peltier.begin<THERMO_COOLER_PIN>();
+  dht.begin();
+  temps.begin();
+  cooler.setMaxFloat(COOLER_MAX_FLOAT);
   cooler.begin();
+
+  buttons.begin();
+  // Half way through Timer0's count so it doesn't land on the millis() overflow
+  OCR0B = 0x80;
+  TIMSK0 |= _BV(OCIE0B);
+
   lcd.createChar(ARROW_CHAR, arrowChar);
   lcd.begin(16, LCD_ROWS);
 
   LOG(LOG_DEBUG, "Building LCD menu tree...");
   mm_idle.add_menu(&mm);
   mm.add_menu(&mm_feeds);
-  mm_feeds.add_menu(&feeds_feed1);
-  mm_feeds.add_menu(&feeds_feed2);
+  for (uint8_t i = 0; i < NUM_FEEDS; i++)
+  {
+    feedMenuStor[i].arrow_locs = feedMenuArrowLocs;
+    feedMenuStor[i].num_locs = sizeof(feedMenuArrowLocs) / sizeof(feedMenuArrowLocs[0]);
+    feedMenuStor[i].curr_loc = 0;
+    feedMenuStor[i].index = i;
+    feedMenus[i].set_name(feeds[i].getName());
+    feedMenus[i].setStorage(&feedMenuStor[i], sizeof(feedMenuStor[i]));
+    feedMenus[i].set_display_callback(&displayFeed);
+    mm_feeds.add_menu(&feedMenus[i]);
+  }
   mm.add_menu(&mm_temp);
   mm.add_menu(&mm_clock);
   mm.add_menu(&mm_wifi);
@@ -173,18 +222,31 @@ void setup() {
   ms.set_root_menu(&mm_idle);
 
   // Set input handler
-  currHandler = IdleMenuHandler;
+  uiChanged();
   LOG(LOG_DEBUG, "Done building LCD menu tree");
+  // Draw right away, the wifi setup below takes a while before tasks run
   ms.display();
 
-  if (wifi.setOprToSoftAP() && wifi.setSoftAPParam(SSID, PASSWORD)
-      && wifi.enableMUX() && wifi.startTCPServer(80) && wifi.setTCPServerTimeout(10)) {
+  // Channel 7, WPA2
+  wifiSerial.begin(115200);
+  if (webServer.command(F("AT+CWMODE=2"))
+      && webServer.command(F("AT+CWSAP=\"" SSID "\",\"" PASSWORD "\",7,4"))
+      && webServer.command(F("AT+CIPMUX=1")) && webServer.command(F("AT+CIPSERVER=1,"), 80)
+      && webServer.command(F("AT+CIPSTO="), WIFI_SERVER_TIMEOUT)) {
     LOG(LOG_DEBUG, "Created AP SSID: '%s', PASS: '%s'", SSID, PASSWORD);
+    if (!wifiSerial.hasFlowControl()) {
+      LOG(LOG_DEBUG, "Wifi link at 115200 baud, no RTS/CTS");
+    } else if (webServer.setBaud(WIFI_BAUD, true)) {
+      LOG(LOG_DEBUG, "Wifi link at %lu baud with RTS/CTS", (unsigned long)WIFI_BAUD);
+    } else {
+      LOG(LOG_ERROR, "Wifi link staying at 115200 baud");
+    }
+    webServer.begin(webRoutes, sizeof(webRoutes)/sizeof(webRoutes[0]));
   } else {
     LOG(LOG_ERROR, "Failed to create wifi AP");
   }
 
-  LOG(LOG_DEBUG, "Startup complete! Starting tasks....\n");
+  LOG(LOG_DEBUG, "Startup complete! Starting tasks, type 'help' for serial commands....\n");
   piezo.play(&SoundPlayer::boot);
   tWatchdog.enableDelayed();
 
@@ -195,33 +257,35 @@ void loop() {
   ts.execute();
 }
 
-void displayFeed1(Menu *cp_menu)
+// Which input handler goes with each screen, the display callbacks below
+// only draw and leave this to uiChanged()
+InputHandler menuHandler(Menu const *menu)
 {
-  //temporarily stop servicing feeds
-  if (currHandler != Feeder1MenuHandler) LOG(LOG_DEBUG, "Entering feed menu, disabling feed servicing");
-  feeds[0].lockFeed();
-  currHandler = Feeder1MenuHandler;
-  displayFeed(0, (StorageMenu *)cp_menu);
+  if (menu == &mm_idle) return IdleMenuHandler;
+  if (menu >= feedMenus && menu < feedMenus + NUM_FEEDS) return FeederMenuHandler;
+  if (menu == &mm_temp) return TemperatureMenuHandler;
+  if (menu == &mm_wifi || menu == &mm_clock) return StaticMenuHandler;
+  return MenuNavigatorHandler;
 }
 
-void displayFeed2(Menu *cp_menu)
+// Frame rate cap, a burst of presses between two frames is drawn once
+void renderLcd()
 {
-  if (currHandler != Feeder2MenuHandler) LOG(LOG_DEBUG, "Entering feed menu, disabling feed servicing");
-  feeds[1].lockFeed();
-  currHandler = Feeder2MenuHandler;
-  displayFeed(1, (StorageMenu *)cp_menu);
+  TRACE_TASK();
+  static unsigned long lastFrame = 0;
 
+  // The idle clock and temperatures change on their own
+  if (!lcdDirty && millis() - lastFrame < LCD_AUTO_REDRAW) return;
+  lcdDirty = false;
+  lastFrame = millis();
+  ms.display();
 }
 
-
-void displayFeed(const uint8_t index, StorageMenu *cp_menu)
+void displayFeed(Menu *cp_menu)
 {
-  FeedCompart curr = feeds[index];
-  currHandler = (index) ? Feeder2MenuHandler : Feeder1MenuHandler;
-  FeedMenuStorage *stor = (FeedMenuStorage *)cp_menu->getStorage();
-  const char lf[] = "Left Feeder";
-  const char rf[] = "Right Feeder";
-  const char *name = index ? rf : lf;
+  FeedMenuStorage *stor = (FeedMenuStorage *)((StorageMenu *)cp_menu)->getStorage();
+  FeedCompart &curr = feeds[stor->index];
+  const char *name = curr.getName();
 
   lcd.clear();
   lcd.setCursor(calcLcdTitleCenter(name), 0);
@@ -241,53 +305,9 @@ void displayFeed(const uint8_t index, StorageMenu *cp_menu)
   lcd.write(ARROW_CHAR);
 }
 
-void displayMenu(Menu *cp_menu) {
-
-  currHandler = MenuNavigatorHandler;
-  lcd.clear();
-  lcd.setCursor(0, 0);
-
-  // Display the menu
-  byte prev = cp_menu->get_prev_menu_component_num();
-  byte curr = cp_menu->get_cur_menu_component_num();
-  byte last = cp_menu->get_num_menu_components() - 1;
-
-  byte start, stop;
-  MenuComponent const *mi;
-
-  //first
-  if (!curr) {
-    start = 0;
-    stop = min(last, LCD_ROWS - 1);
-  } else if (last == curr && last == prev) {
-    start = max(0, last + 1 - LCD_ROWS);
-    stop = last;
-  } else if (curr > prev) {
-    //Moved down
-    start = prev;
-    stop = start + LCD_ROWS - 1;
-  } else {
-    // going up
-    start = curr;
-    stop = min(last, start + (LCD_ROWS - 1));
-  }
-
-  // draw
-  for (int i = start, count = 0; i <= stop; i++, count++)
-  {
-    lcd.setCursor(0, count);
-    mi = cp_menu->get_menu_component(i);
-    lcd.print(i + 1);
-    curr == i ? lcd.write(ARROW_CHAR) : lcd.write(' ');
-    lcd.print(mi->get_name());
-  }
-
-}
-
 void displayTemp(Menu *cp_menu)
 {
   char str[25];
-  currHandler = TemperatureMenuHandler;
   lcd.clear();
   snprintf(str, sizeof(str), "%s %d%cF %d%%", cp_menu->get_name(),
            (int)round(cooler.getTemp()), 0xDF, cooler.getPwmPercent());
@@ -305,7 +325,6 @@ void displayTemp(Menu *cp_menu)
 
 void displaySystemInfo(Menu *cp_menu)
 {
-  currHandler = MenuNavigatorHandler;
   char str[] = "Version: " VERSION;
   lcd.clear();
   lcd.setCursor(calcLcdTitleCenter(str), 0);
@@ -316,45 +335,46 @@ void displaySystemInfo(Menu *cp_menu)
 
 void displayIdleMenu(Menu *cp_menu)
 {
-  currHandler = IdleMenuHandler;
   char str[17];
   lcd.clear();
   //Format the time string
-  char mstr[5];
-  char sstr[5];
-  const char ltt[] = "0%d";
-  const char gtet[] = "%d";
-  int mins = minute();
-  int secs = second();
-  snprintf(mstr, sizeof(mstr), mins < 10 ? ltt : gtet, mins);
-  snprintf(sstr, sizeof(sstr), secs < 10 ? ltt : gtet, secs);
-  snprintf(str, sizeof(str), "%s %d:%s:%s", dayShortStr(weekday()), hour(), mstr, sstr);
+  const tmElements_t &tm = timeSnapshot().Elements;
+  snprintf(str, sizeof(str), "%s %d:%02d:%02d", dayShortStr(tm.Wday), tm.Hour, tm.Minute, tm.Second);
   lcd.setCursor(calcLcdTitleCenter(str), 0);
   lcd.print(str);
 
-  //Second line
-  snprintf(str, sizeof(str), "1:%s %dF 2:%s", feeds[0].isEnabled() ? "On" : "Off",
-           (int)round(cooler.getTemp()), feeds[1].isEnabled() ? "On" : "Off");
+  //Second line, the temperature then the number of each enabled feed
+  uint8_t n = snprintf(str, sizeof(str), "%dF On:", (int)round(cooler.getTemp()));
+  for (uint8_t i = 0; i < NUM_FEEDS && n < sizeof(str) - 1; i++)
+  {
+    str[n++] = feeds[i].isEnabled() ? '1' + i : '-';
+  }
+  str[n] = '\0';
   lcd.setCursor(calcLcdTitleCenter(str), 1);
   lcd.print(str);
 }
 
 void displayWifiMenu(Menu *cp_menu)
 {
-  currHandler = StaticMenuHandler;
-  String ip = wifi.getLocalIP();
-  
+  // Cached by webServer, so redrawing costs no AT round trip
+  const WifiStatus &net = webServer.status();
+
   lcd.clear();
   lcd.setCursor(0, 0);
-  // I have to do this due to incompatibility
-  lcd.print(ip.substring(ip.indexOf('"')+1, ip.indexOf('"', ip.indexOf('"')+1)));
+  if (net.up) {
+    lcd.print(net.ip);
+    // Stations joined, in the top right corner
+    lcd.setCursor(net.stations < 10 ? 15 : 14, 0);
+    lcd.print(net.stations);
+  } else {
+    lcd.print(F("Wifi down"));
+  }
   lcd.setCursor(0, 1);
   lcd.print(PASSWORD);
 }
 
 void displayClockMenu(Menu *cp_menu)
 {
-  currHandler = StaticMenuHandler;
   lcd.clear();
   lcd.setCursor(0, 0);
   lcd.print("Set Time over");
@@ -363,67 +383,32 @@ void displayClockMenu(Menu *cp_menu)
 }
 
 
-void serviceSerial() {
-  char inChar;
-  if ((inChar = Serial.read()) > 0) {
-    switch (inChar) {
-      case 'w': // Previus item
-        ms.prev();
-        ms.display();
-        break;
-      case 's': // Next item
-        ms.next();
-        ms.display();
-        break;
-      case 'a': // Back presed
-        ms.back();
-        ms.display();
-        break;
-      case 'd': // Select presed
-        ms.select(false);
-        ms.display();
-        break;
-      case '?':
-      case 'h': // Display help
-        break;
-      default:
-        break;
-    }
-  }
+void serviceClockSync()
+{
+  TRACE_TASK();
+  if (!clockSync.service()) tClockSync.disable();
 }
 
 void servicePiezo()
 {
+  TRACE_TASK();
   piezo.service();
 }
 
 bool anyBtnWasPressed()
 {
-  for (uint8_t i = 0; i < sizeof(bAll) / sizeof(bAll[0]); i++)
-  {
-    // Some weird reason where they are Null
-    if (bAll[i]->wasPressed()) return true;
-  }
-  return false;
+  return buttons.pressed();
 }
 
 bool anyBtnIsPressed()
 {
-  for (uint8_t i = 0; i < sizeof(bAll) / sizeof(bAll[0]); i++)
-  {
-    // Some weird reason where they are Null
-    if (bAll[i]->isPressed()) return true;
-  }
-  return false;
+  return buttons.held();
 }
 
+// Debouncing happens in the timer tick, this just takes the presses since last pass
 void serviceButtons()
 {
-  for (uint8_t i = 0; i < sizeof(bAll) / sizeof(bAll[0]); i++)
-  {
-    // Some weird reason where they are Null
-    if (bAll[i]) bAll[i]->read();
-  }
+  buttons.update();
 
   if (anyBtnWasPressed()) {
     piezo.click();
@@ -438,108 +423,304 @@ void serviceButtons()
 
 void serviceFeeds()
 {
+  TRACE_TASK();
   bool enCooler = false;
-  for (uint8_t i = 0; i < sizeof(feeds) / sizeof(feeds[0]); i++)
+  for (uint8_t i = 0; i < NUM_FEEDS; i++)
   {
     feeds[i].service();
     enCooler |= feeds[i].isEnabled();
   }
+  // Every door that moved this pass goes out together
+  if (feedUsesExpander()) servoExpander.flush();
   // Change state of cooler if neccisary
   if (enCooler != cooler.isEnabled()) enCooler ? cooler.enable() : cooler.disable();
 
 }
 
+// Soonest door opening of any enabled feed, 0 while one is open
+long secsToNextFeed()
+{
+  time_t next = 0;
+  for (uint8_t i = 0; i < NUM_FEEDS; i++)
+  {
+    time_t t = feeds[i].getNextOpen();
+    if (t && (!next || t < next)) next = t;
+  }
+  if (!next) return TC_NO_FEED;
+  time_t curr = timeSnapshot().Time;
+  return next > curr ? (long)(next - curr) : 0;
+}
+
 void serviceCooler()
 {
+  TRACE_TASK();
+  bool slow = temps.service();
+  cooler.setNextFeed(secsToNextFeed());
   cooler.service();
-  LOG(LOG_DEBUG, "System Temp %dF (%d%%)", (int)round(cooler.getTemp()), cooler.getPwmPercent());
+  // Only as often as the DHT is read, this runs a few times a second
+  if (slow) {
+    LOG(LOG_DEBUG, "System Temp %dF (%d%%) RH %d%%", (int)round(cooler.getTemp()), cooler.getPwmPercent(),
+        (int)round(temps.getHumidity()));
+  }
 
 }
 
 void serviceWifi()
 {
-  static int lastMux = -1;
-  char buffer[200];
-  uint8_t mux_id;
-  uint32_t len = wifi.recv(&mux_id, (uint8_t*)buffer, sizeof(buffer), 50);
-
-  // Otherwise service old client
-  if (len > 0 && lastMux != mux_id) {
-    LOG(LOG_DEBUG, "Wifi got client id:'%d'", mux_id);
-    char rply[] PROGMEM =
-      "HTTP/1.1 200 OK\r\n"
-      "Content-Type: text/html\r\n"
-      "Connection: close\r\n"
-      "\r\n"      
-      "<!DOCTYPE html>"
-      "<html>"
-      "<head>"
-      "<meta charset=\"UTF-8\">"
-      "<title>Kitty Feeder 2K</title>"
-      "</head>"
-      "<body>"
-      "<h1>Kitty Feeder 2K Web Interface!</h1>"
-      "<p style='color: red'>Note that this web interface is under development</p>"
-      "<p>You are running: '" VERSION 
-      "', visit <a href='https://github.com/wizard97/KittyFeeder2'>the GitHub repo for firware updates</a>";
-
-    // Send data
-    wifi.send(mux_id, (uint8_t *)rply, sizeof(rply));
-
-    //Format the time string
-    char mstr[5];
-    char sstr[5];
-    const char ltt[] = "0%d";
-    const char gtet[] = "%d";
-    int mins = minute();
-    int secs = second();
-    snprintf(mstr, sizeof(mstr), mins < 10 ? ltt : gtet, mins);
-    snprintf(sstr, sizeof(sstr), secs < 10 ? ltt : gtet, secs);
-    
-    unsigned int buflen = MIN((unsigned int)snprintf((char*)buffer, sizeof(buffer), 
-        "<p>System Time: %s %d:%s:%s (uptime: %d mins)</p>", 
-        dayShortStr(weekday()), hour(), mstr, sstr, (int)(millis()/60000)), sizeof(buffer)-1);
-    wifi.send(mux_id, (uint8_t *)buffer, buflen);
-        
-    buflen = MIN((unsigned int)snprintf((char*)buffer, sizeof(buffer), 
-        "<p>Cooler: %dF (set: %dF) (%d%%)</p>", 
-        (int)round(cooler.getTemp()), cooler.getSetTemp(), cooler.getPwmPercent()), sizeof(buffer)-1);
-
-    wifi.send(mux_id, (uint8_t *)buffer, buflen);
-
-    buflen = MIN((unsigned int)snprintf((char*)buffer, sizeof(buffer), 
-        "<p>Feed #1: %s (%s, %d:%d), Feed #2: %s (%s, %d:%d) </p><body></html>", 
-        feeds[0].isEnabled() ? "On" : "Off", dayShortStr(feeds[0].getWeekDay()), feeds[0].getHour(), feeds[0].getMin(),
-        feeds[1].isEnabled() ? "On" : "Off", dayShortStr(feeds[1].getWeekDay()), feeds[1].getHour(), feeds[1].getMin()),
-        sizeof(buffer)-1);
-
-    wifi.send(mux_id, (uint8_t *)buffer, buflen);
-
-    if (wifi.releaseTCP(mux_id)) {
-      LOG(LOG_DEBUG, "Released client id: '%d'", mux_id);
-    } else {
-      LOG(LOG_ERROR, "Error releasing client id: '%d'", mux_id);
+  TRACE_TASK();
+  updateTelemetry();
+  webServer.service();
+}
+
+// What /events last reported, telemetrySeq moves on whenever any of it changes
+typedef struct Telemetry
+{
+  int16_t temp;
+  uint8_t pwm;
+  // Bit per feed, set while its door is not closed
+  uint8_t doors;
+  uint8_t minute;
+} Telemetry;
+
+Telemetry telemetry;
+uint16_t telemetrySeq = 0;
+
+void updateTelemetry()
+{
+  Telemetry t;
+  t.temp = round(cooler.getTemp());
+  t.pwm = cooler.getPwmPercent();
+  t.doors = 0;
+  for (uint8_t i = 0; i < NUM_FEEDS; i++)
+  {
+    if (feeds[i].isDoorOpen()) t.doors |= 1 << i;
+  }
+  t.minute = timeSnapshot().Elements.Minute;
+
+  if (t.temp != telemetry.temp || t.pwm != telemetry.pwm || t.doors != telemetry.doors
+      || t.minute != telemetry.minute) {
+    telemetry = t;
+    telemetrySeq++;
+  }
+}
+
+// Static top of the status page, streamed straight out of flash
+const char statusPageHead[] PROGMEM =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/html\r\n"
+  "Connection: close\r\n"
+  "\r\n"
+  "<!DOCTYPE html>"
+  "<html>"
+  "<head>"
+  "<meta charset=\"UTF-8\">"
+  "<title>Kitty Feeder 2K</title>"
+  "</head>"
+  "<body>"
+  "<h1>Kitty Feeder 2K Web Interface!</h1>"
+  "<p style='color: red'>Note that this web interface is under development</p>"
+  "<p>You are running: '" VERSION
+  "', visit <a href='https://github.com/wizard97/KittyFeeder2'>the GitHub repo for firware updates</a>";
+
+// Keeps the page current from /events instead of reloading it
+const char statusPageTail[] PROGMEM =
+  "<script>"
+  "new EventSource('/events').onmessage=function(e){"
+  "var d=JSON.parse(e.data),v={time:d[0],temp:d[1],pwm:d[2]};"
+  "d[3].split('').forEach(function(o,i){v['door'+(i+1)]=o=='1'?'open':'closed';});"
+  "for(var k in v){var el=document.getElementById(k);if(el)el.textContent=v[k];}"
+  "};"
+  "</script>"
+  "</body>"
+  "</html>";
+
+// Called again for every chunk, link.part says which piece of the page is next
+int16_t statusPage(WifiLink &link, char *buf, uint16_t size)
+{
+  int n;
+
+  switch (link.part)
+  {
+    case 0:
+      link.part++;
+      return wifiSendP(link, statusPageHead, sizeof(statusPageHead) - 1);
+
+    case 1: {
+      const tmElements_t &tm = timeSnapshot().Elements;
+      n = snprintf(buf, size, "<p>System Time: <span id='time'>%s %d:%02d</span> (uptime: %d mins)</p>",
+          dayShortStr(tm.Wday), tm.Hour, tm.Minute, (int)(millis()/60000));
+      break;
+    }
+
+    case 2:
+      n = snprintf(buf, size, "<p>Cooler: <span id='temp'>%d</span>F (set: %dF) (<span id='pwm'>%d</span>%%)</p>",
+          (int)round(cooler.getTemp()), cooler.getSetTemp(), cooler.getPwmPercent());
+      break;
+
+    case 3: {
+      const WifiStatus &net = webServer.status();
+      n = snprintf(buf, size, "<p>Wifi: %d stations, %d links</p>", net.stations, net.links);
+      break;
+    }
+
+    // A part per feed, then the script
+    default:
+      if (link.part < 4 + NUM_FEEDS) {
+        uint8_t i = link.part - 4;
+        n = snprintf(buf, size, "<p>%s: %s (%s, %d:%02d), door <span id='door%d'>%s</span></p>",
+            feeds[i].getName(), feeds[i].isEnabled() ? "On" : "Off", dayShortStr(feeds[i].getWeekDay()),
+            feeds[i].getHour(), feeds[i].getMin(), i + 1, feeds[i].isDoorOpen() ? "open" : "closed");
+        break;
+      }
+      if (link.part == 4 + NUM_FEEDS) {
+        link.part++;
+        return wifiSendP(link, statusPageTail, sizeof(statusPageTail) - 1);
+      }
+      return WIFI_RESPONSE_DONE;
+  }
+
+  link.part++;
+  return MIN(n, size - 1);
+}
+
+// Static files from web/, gzipped into flash by tools/webassets.py. Every
+// browser we care about takes gzip so there is no plain copy to fall back on.
+// no-cache makes the browser revalidate with the ETag on every load, so a
+// repeat visit only costs a 304 but a firmware update shows up right away.
+int16_t assetPage(WifiLink &link, char *buf, uint16_t size)
+{
+  WebAsset asset;
+  uint8_t i;
+  for (i = 0; i < sizeof(webAssets)/sizeof(webAssets[0]); i++)
+  {
+    memcpy_P(&asset, &webAssets[i], sizeof(asset));
+    if (!strcmp(asset.path, httpPath(link))) break;
+  }
+  if (i == sizeof(webAssets)/sizeof(webAssets[0])) return WIFI_RESPONSE_DONE;
+
+  switch (link.part++)
+  {
+    case 0: {
+      int n;
+      // Substring match covers lists, weak tags and '*'
+      const char *match = httpHeader(link, HTTP_IF_NONE_MATCH);
+      if (match && (strstr(match, asset.etag) || !strcmp_P(match, PSTR("*")))) {
+        link.part = 3;
+        n = snprintf_P(buf, size, PSTR("HTTP/1.1 304 Not Modified\r\n"
+            "ETag: %s\r\n"
+            "Cache-Control: no-cache\r\n"
+            "Connection: close\r\n"
+            "\r\n"), asset.etag);
+      } else {
+        n = snprintf_P(buf, size, PSTR("HTTP/1.1 200 OK\r\n"
+            "Content-Type: %s\r\n"
+            "Content-Encoding: gzip\r\n"
+            "Content-Length: %u\r\n"), asset.type, asset.len);
+      }
+      return MIN(n, size - 1);
+    }
+
+    // Rest of the headers, all of them don't fit in one chunk
+    case 1: {
+      int n = snprintf_P(buf, size, PSTR("ETag: %s\r\n"
+          "Cache-Control: no-cache\r\n"
+          "Connection: close\r\n"
+          "\r\n"), asset.etag);
+      return MIN(n, size - 1);
+    }
+
+    case 2:
+      return wifiSendP(link, (const char *)asset.data, asset.len);
+
+    default:
+      return WIFI_RESPONSE_DONE;
+  }
+}
+
+const char eventsHead[] PROGMEM =
+  "HTTP/1.1 200 OK\r\n"
+  "Content-Type: text/event-stream\r\n"
+  "Cache-Control: no-cache\r\n"
+  "\r\n"
+  "retry: 5000\n\n";
+
+// Server-Sent Events, the link stays open and only gets a message when
+// telemetry changes. link.offset holds the telemetrySeq it last sent.
+int16_t eventsPage(WifiLink &link, char *buf, uint16_t size)
+{
+  if (link.part == 0) {
+    link.part++;
+    // Make sure the first message goes out right after the headers
+    link.offset = telemetrySeq - 1;
+    return wifiSendP(link, eventsHead, sizeof(eventsHead) - 1);
+  }
+
+  if (link.offset != telemetrySeq) {
+    link.offset = telemetrySeq;
+    const tmElements_t &tm = timeSnapshot().Elements;
+    // [time, temp, pwm, doors] with a '1' (open) or '0' per door, 33 bytes
+    // with two feeds instead of 62 with named keys, the pages know the order
+    int n = snprintf(buf, size, "data: [\"%s %d:%02d\",%d,%d,\"",
+        dayShortStr(tm.Wday), tm.Hour, tm.Minute, telemetry.temp, telemetry.pwm);
+    for (uint8_t i = 0; i < NUM_FEEDS; i++)
+    {
+      buf[n++] = (telemetry.doors >> i) & 1 ? '1' : '0';
     }
-    lastMux = mux_id;
-  } else if (len <= 0){
-    lastMux = -1;
+    n += snprintf(buf + n, size - n, "\"]\n\n");
+    return MIN(n, size - 1);
+  }
+
+  // A comment keeps the ESP8266 from timing the link out
+  if (millis() - link.lastActivity > SSE_KEEPALIVE_TIME) {
+    buf[0] = ':';
+    buf[1] = '\n';
+    buf[2] = '\n';
+    return 3;
   }
+  return 0;
 }
 
 
-double getTemp()
+// Only what temps read this pass, the cooler's estimator coasts through gaps
+bool getTemp(double &temp, double &sigma)
 {
-  // Read temperature as Fahrenheit (isFahrenheit = true)
-  float f = dht.readTemperature(true);
+  return temps.read(temp, sigma);
+}
 
-  // Check if any reads failed and exit early (to try again).
-  if (isnan(f)) {
-    LOG(LOG_ERROR, "Unable to read temperature sensor");
+// The DS3232's own sensor, 0.25C steps over a couple of short I2C reads.
+// Left alone it only converts every 64s, so every read starts the next
+// conversion, which is done well before TEMP_FAST_INTERVAL is up.
+double getFastTemp()
+{
+  uint8_t t[2];
+  uint8_t status;
 
-    return 0.0;
+  if (RTC.readRTC(TEMP_MSB, t, 2)) return NAN;
+  if (!RTC.readRTC(RTC_STATUS, &status, 1) && !(status & _BV(BSY))) {
+    RTC.writeRTC(RTC_CONTROL, RTC.readRTC(RTC_CONTROL) | _BV(CONV));
   }
-  return f;
+  // Top 10 bits, two's complement quarter degrees C
+  int16_t quarters = (int16_t)((t[0] << 8) | t[1]) >> 6;
+  return quarters * 0.45 + 32;
+}
 
+// Blocks for ~5ms, only called every TEMP_SLOW_INTERVAL
+bool getSlowTemp(double &temp, double &humidity)
+{
+  // Read temperature as Fahrenheit (isFahrenheit = true), the humidity comes from the same read
+  float f = dht.readTemperature(true);
+  float h = dht.readHumidity();
+
+  if (isnan(f) || isnan(h)) return false;
+  temp = f;
+  humidity = h;
+  return true;
+}
+
+// Only sets where the output ramps to, the Timer0 tick does the rest
+void setCoolerPwm(uint8_t duty)
+{
+  peltier.setDuty(duty);
 }
 
 uint8_t calcLcdTitleCenter(const char* str)
@@ -549,23 +730,24 @@ uint8_t calcLcdTitleCenter(const char* str)
 
 }
 
-// Pin change interrupt for buttons
-ISR(PCINT1_vect)
+// Timer0 already runs for millis(), its compare B match is a free 1.024ms tick
+ISR(TIMER0_COMPB_vect)
 {
-  serviceButtons();
+  buttons.tick();
+  peltier.tick();
 }
 
 
 void enableWifi()
 {
-  pinMode(ESP_RESET_PIN, OUTPUT);
-  digitalWrite(ESP_RESET_PIN, HIGH);
+  FastPin<ESP_RESET_PIN>::output();
+  FastPin<ESP_RESET_PIN>::high();
 }
 
 void disableWifi()
 {
-  pinMode(ESP_RESET_PIN, OUTPUT);
-  digitalWrite(ESP_RESET_PIN, LOW);
+  FastPin<ESP_RESET_PIN>::output();
+  FastPin<ESP_RESET_PIN>::low();
 }
 
 bool wdtOn() {
@@ -597,19 +779,36 @@ void wdtOff()
 */
 void wdtService()
 {
+  TRACE_TASK();
   wdt_reset();
 }
 
 /**
-   Watchdog timeout ISR
-
+   Second half of the watchdog ISR, an ordinary function with its own
+   prologue so it can use the stack. sp is SP as the ISR found it.
+   extern "C" so the ISR's asm can name it.
 */
-ISR(WDT_vect)
+extern "C" void watchdogCapture(const uint8_t *sp) __attribute__((noinline, noreturn, used));
+void watchdogCapture(const uint8_t *sp)
 {
   Task& T = ts.currentTask();
+  crashLog.capture(sp, (uint8_t)T.getId(), (uint8_t)T.getControlPoint());
+}
 
-  digitalWrite(13, HIGH);
-  EEPROM.write(EEPROM_WDT_DEBUG_LOC, (byte)T.getId());
-  EEPROM.write(EEPROM_WDT_DEBUG_LOC + 1, (byte)T.getControlPoint());
-  digitalWrite(13, LOW);
+/**
+   Watchdog timeout ISR
+   Naked so the stack still holds the interrupted PC right above SP,
+   it never returns since the crash log forces the reset. Without a
+   prologue only basic asm is safe in here, so it just hands SP to
+   watchdogCapture() in the first argument registers.
+*/
+ISR(WDT_vect, ISR_NAKED)
+{
+  __asm__ __volatile__ (
+    // Whatever was interrupted may have left r1 dirty
+    "clr __zero_reg__\n\t"
+    "in r24, __SP_L__\n\t"
+    "in r25, __SP_H__\n\t"
+    "jmp watchdogCapture\n\t"
+  );
 }
@@ -0,0 +1,60 @@
+/*
+  MenuDisplay.h - Draws a plain list menu on the LCD, a page of items
+  with the arrow on the selected one
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef MENU_DISPLAY_H
+#define MENU_DISPLAY_H
+
+#include "Arduino.h"
+#include <LiquidCrystal.h>
+#include "MenuSystem.h"
+#include "FeederUtils.h"
+#include "FeederConfig.h"
+
+extern LiquidCrystal lcd;
+
+void displayMenu(Menu *cp_menu) {
+
+  lcd.clear();
+  lcd.setCursor(0, 0);
+
+  // Display the menu
+  byte prev = cp_menu->get_prev_menu_component_num();
+  byte curr = cp_menu->get_cur_menu_component_num();
+  byte last = cp_menu->get_num_menu_components() - 1;
+
+  byte start, stop;
+  MenuComponent const *mi;
+
+  //first
+  if (!curr) {
+    start = 0;
+    stop = MIN(last, LCD_ROWS - 1);
+  } else if (last == curr && last == prev) {
+    start = MAX(0, last + 1 - LCD_ROWS);
+    stop = last;
+  } else if (curr > prev) {
+    //Moved down
+    start = prev;
+    stop = start + LCD_ROWS - 1;
+  } else {
+    // going up
+    start = curr;
+    stop = MIN(last, start + (LCD_ROWS - 1));
+  }
+
+  // draw
+  for (int i = start, count = 0; i <= stop; i++, count++)
+  {
+    lcd.setCursor(0, count);
+    mi = cp_menu->get_menu_component(i);
+    lcd.print(i + 1);
+    curr == i ? lcd.write(ARROW_CHAR) : lcd.write(' ');
+    lcd.print(mi->get_name());
+  }
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+/*
+  NoHeap.h - Replaces malloc() and friends so a build that still calls
+  them fails to link, include it once from the sketch
+  Created by D. Aaron Wisner
+  Released into the public domain.
+
+  Each replacement calls a function that is never defined. With
+  -ffunction-sections and --gc-sections the replacements are dropped when
+  nothing uses them; if anything does, avr-ld stops with
+    undefined reference to `heap_used_in_NO_HEAP_build'
+  and the caller shows up in the error. new goes through malloc() in the
+  core, so it is caught too. Defining malloc() here also keeps libc's
+  malloc.o, and its __brkval, out of the link, so that is defined as well
+  for freeMemory(), with libc's type.
+
+  NO_HEAP_LINK_TEST adds a constructor that allocates on purpose, which
+  --gc-sections can't drop, to check the link really fails.
+*/
+#ifndef NO_HEAP_H
+#define NO_HEAP_H
+
+#include <stddef.h>
+
+extern "C" {
+
+void heap_used_in_NO_HEAP_build();
+
+char *__brkval = NULL;
+
+void *malloc(size_t)
+{
+    heap_used_in_NO_HEAP_build();
+    return NULL;
+}
+
+void *calloc(size_t, size_t)
+{
+    heap_used_in_NO_HEAP_build();
+    return NULL;
+}
+
+void *realloc(void *, size_t)
+{
+    heap_used_in_NO_HEAP_build();
+    return NULL;
+}
+
+// Nothing was ever handed out
+void free(void *) {}
+
+}
+
+#ifdef NO_HEAP_LINK_TEST
+void * volatile noHeapLinkTestPtr;
+
+__attribute__((constructor)) static void noHeapLinkTest()
+{
+    noHeapLinkTestPtr = malloc(1);
+}
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+#include "Pca9685.h"
+#include "FeederUtils.h"
+
+#define PCA9685_MODE1 0x00
+#define PCA9685_MODE2 0x01
+#define PCA9685_LED0_ON_L 0x06
+#define PCA9685_PRESCALE 0xFE
+
+#define MODE1_RESTART 0x80
+#define MODE1_AI 0x20
+#define MODE1_SLEEP 0x10
+#define MODE2_OUTDRV 0x04
+// Bit 4 of LEDn_OFF_H holds the output low no matter what the counts say
+#define LED_FULL_OFF 0x10
+
+#define PCA9685_OSC_HZ 25000000UL
+// Channels per burst, 4 registers each after the register address
+#define PCA9685_BURST ((BUFFER_LENGTH - 1) / 4)
+
+Pca9685::Pca9685(uint8_t addr)
+: addr(addr)
+{
+    tickNs = 0;
+    dirty = 0;
+    memset(offTicks, 0, sizeof(offTicks));
+}
+
+bool Pca9685::begin()
+{
+    uint8_t prescale = (PCA9685_OSC_HZ + 2048UL * PCA9685_SERVO_FREQ) / (4096UL * PCA9685_SERVO_FREQ) - 1;
+    tickNs = (prescale + 1) * (1000000000UL / PCA9685_OSC_HZ);
+
+    Wire.begin();
+    // The DS3232 on the same bus is good for 400kHz too
+    Wire.setClock(400000);
+
+    // The prescaler can only be written while the oscillator sleeps
+    if (!writeReg(PCA9685_MODE1, MODE1_SLEEP | MODE1_AI)
+        || !writeReg(PCA9685_PRESCALE, prescale)
+        || !writeReg(PCA9685_MODE2, MODE2_OUTDRV)
+        || !writeReg(PCA9685_MODE1, MODE1_AI)) {
+        LOG(LOG_ERROR, "PCA9685 at 0x%02x not responding", addr);
+        return false;
+    }
+    // Oscillator needs 500us to start before outputs can be restarted
+    delayMicroseconds(500);
+    writeReg(PCA9685_MODE1, MODE1_AI | MODE1_RESTART);
+
+    // Start everything off, channels come on with their first setAngle()
+    dirty = 0xFFFF;
+    flush();
+    LOG(LOG_DEBUG, "PCA9685 at 0x%02x, prescale %d", addr, prescale);
+    return true;
+}
+
+void Pca9685::setAngle(uint8_t channel, uint8_t deg)
+{
+    setPulse(channel, map(constrain(deg, 0, 180), 0, 180, PCA9685_MIN_PULSE, PCA9685_MAX_PULSE));
+}
+
+void Pca9685::setPulse(uint8_t channel, uint16_t us)
+{
+    if (channel >= PCA9685_CHANNELS || !tickNs) return;
+
+    uint16_t ticks = (uint32_t)us * 1000 / tickNs;
+    if (ticks == offTicks[channel]) return;
+    offTicks[channel] = ticks;
+    dirty |= 1U << channel;
+}
+
+bool Pca9685::flush()
+{
+    uint8_t ch = 0;
+
+    while (dirty)
+    {
+        while (!(dirty & (1U << ch))) ch++;
+
+        // Clean channels between two dirty ones ride along, a few extra
+        // bytes are cheaper than another start, address and register
+        Wire.beginTransmission(addr);
+        Wire.write(PCA9685_LED0_ON_L + 4 * ch);
+        for (uint8_t n = 0; n < PCA9685_BURST && ch < PCA9685_CHANNELS && (dirty >> ch); n++, ch++)
+        {
+            // Pulses start a quarter frame apart so servos don't all pull
+            // their stall current at the same moment
+            uint16_t on = (ch & 3) * 1024;
+            uint16_t off = (on + offTicks[ch]) & 0x0FFF;
+            Wire.write(on & 0xFF);
+            Wire.write(on >> 8);
+            Wire.write(off & 0xFF);
+            Wire.write((off >> 8) | (offTicks[ch] ? 0 : LED_FULL_OFF));
+        }
+        if (Wire.endTransmission()) return false;
+        // Only now that they made it
+        dirty = ch < PCA9685_CHANNELS ? dirty & (0xFFFFU << ch) : 0;
+    }
+    return true;
+}
+
+bool Pca9685::writeReg(uint8_t reg, uint8_t val)
+{
+    Wire.beginTransmission(addr);
+    Wire.write(reg);
+    Wire.write(val);
+    return !Wire.endTransmission();
+}
@@ -0,0 +1,48 @@
+/*
+  Pca9685.h - Servo pulses from a PCA9685 16 channel I2C PWM chip. Angles
+  are kept in RAM and only the channels that changed go out, in as few
+  auto-increment bursts as the Wire buffer allows.
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef PCA9685_H
+#define PCA9685_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define PCA9685_CHANNELS 16
+// Servo frame rate, same 50Hz the Servo library uses
+#define PCA9685_SERVO_FREQ 50
+// Same angle to pulse mapping as Servo.write(), so open/close angles carry over
+#define PCA9685_MIN_PULSE 544
+#define PCA9685_MAX_PULSE 2400
+
+class Pca9685
+{
+public:
+    Pca9685(uint8_t addr);
+
+    // Sets the frame rate and wakes the chip with every output off, false
+    // if nothing answered at addr
+    bool begin();
+
+    // Only remembered, flush() sends whatever changed
+    void setAngle(uint8_t channel, uint8_t deg);
+    void setPulse(uint8_t channel, uint16_t us);
+
+    // One I2C transaction per run of up to PCA9685_BURST changed channels,
+    // returns false on a bus error and leaves them queued for the next call
+    bool flush();
+
+private:
+    const uint8_t addr;
+    // Length of a PWM step in ns, from the prescaler begin() picked
+    uint16_t tickNs;
+    uint16_t offTicks[PCA9685_CHANNELS];
+    uint16_t dirty;
+
+    bool writeReg(uint8_t reg, uint8_t val);
+};
+
+#endif
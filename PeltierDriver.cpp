@@ -0,0 +1,57 @@
+#include "PeltierDriver.h"
+
+PeltierDriver::PeltierDriver(uint16_t rampMs)
+// Anything under 3ms is as good as instant and would overflow the step
+: rampStep(((uint32_t)PD_TOP << 8) / (rampMs < 3 ? 3 : rampMs))
+{
+    target = 0;
+    level = 0;
+    acc = 0;
+}
+
+// Called from begin() with interrupts off
+void PeltierDriver::startTimer()
+{
+    // Stop it while switching modes, then mode 14 at full clock
+    TCCR3B = 0;
+    TCCR3A = _BV(WGM31);
+    ICR3 = PD_TOP;
+    OCR3A = 0;
+    TCNT3 = 0;
+    TCCR3B = _BV(WGM33) | _BV(WGM32) | _BV(CS30);
+
+    target = 0;
+    level = 0;
+}
+
+void PeltierDriver::setLevel(uint16_t l)
+{
+    if (l > PD_TOP) l = PD_TOP;
+    // Two byte store, tick() must not see half of it
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        target = l;
+    }
+}
+
+uint16_t PeltierDriver::getLevel()
+{
+    uint16_t l;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        l = level;
+    }
+    return l;
+}
+
+// OCR3A of 0 still leaves a one clock pulse every period, so off
+// disconnects the pin instead. PD_TOP is solid high on its own.
+void PeltierDriver::write(uint16_t l)
+{
+    if (l) {
+        OCR3A = l;
+        TCCR3A |= _BV(COM3A1);
+    } else {
+        TCCR3A &= ~_BV(COM3A1);
+    }
+}
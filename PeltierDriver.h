@@ -0,0 +1,77 @@
+/*
+  PeltierDriver.h - Drives the Peltier from Timer3 at 25kHz, out of
+  hearing and smooth enough for the module, and ramps every change in
+  output so it never sees a step in current
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef PELTIER_DRIVER_H
+#define PELTIER_DRIVER_H
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "FastPin.h"
+
+// Fast PWM with ICR3 as TOP and no prescaler, 16MHz / 640 = 25kHz with
+// 640 steps instead of analogWrite()'s 490Hz and 256 steps
+#define PD_TOP 639
+// OC3A, the only pin the timer is set up for
+#define PD_PIN 5
+
+class PeltierDriver
+{
+public:
+    // rampMs is how long going from off to full on (or back) takes
+    PeltierDriver(uint16_t rampMs);
+
+    // Takes Timer3 over for OC3A, Pin must be 5. Pins 2 and 3, the other
+    // Timer3 channels, can't use analogWrite() after this.
+    template<uint8_t Pin>
+    void begin()
+    {
+        static_assert(Pin == PD_PIN, "PeltierDriver only drives OC3A, pin 5");
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            // Held low until the first non zero level
+            FastPin<Pin>::low();
+            FastPin<Pin>::output();
+            startTimer();
+        }
+    }
+
+    // Where the output should ramp to, 0-255 like analogWrite()
+    void setDuty(uint8_t duty) { setLevel(((uint32_t)duty * PD_TOP + 127) / 255); }
+    // Same in timer steps, 0-PD_TOP. Safe from an ISR.
+    void setLevel(uint16_t level);
+    // What the pin is putting out right now, 0-PD_TOP
+    uint16_t getLevel();
+
+    // Call from a ~1ms timer interrupt, moves the output towards the set level
+    void tick()
+    {
+        if (level == target) return;
+
+        // Whole steps out of a Q8 accumulator, a slow ramp moves less than 1 a tick
+        acc += rampStep;
+        uint16_t step = acc >> 8;
+        acc &= 0xFF;
+        if (!step) return;
+
+        if (level < target) level = target - level > step ? level + step : target;
+        else level = level - target > step ? level - step : target;
+        write(level);
+    }
+
+private:
+    // Q8 timer steps per tick
+    const uint16_t rampStep;
+    volatile uint16_t target;
+    // Only touched from tick() once begin() returns
+    volatile uint16_t level;
+    uint16_t acc;
+
+    void startTimer();
+    void write(uint16_t l);
+};
+
+#endif
@@ -0,0 +1,372 @@
+#ifndef SERIAL_SHELL_H
+#define SERIAL_SHELL_H
+
+#include "Arduino.h"
+#include <string.h>
+#include <DS3232RTC.h>
+#include "TimeLib.h"
+#include "MenuSystem.h"
+#include "FeederUtils.h"
+#include "FeederConfig.h"
+#include <TaskScheduler.h>
+#include "WifiServer.h"
+#include "TempSensor.h"
+#include "PeltierDriver.h"
+
+// Longest command line, including the terminator
+#define SHELL_LINE_SIZE 64
+#define SHELL_MAX_ARGS 6
+#define SHELL_NAME_SIZE 9
+#define SHELL_HELP_SIZE 40
+
+// Lives in flash, copied out one at a time while searching
+typedef struct ShellCommand
+{
+    char name[SHELL_NAME_SIZE];
+    bool (*fn)(uint8_t argc, char **argv);
+    char help[SHELL_HELP_SIZE];
+} ShellCommand;
+
+extern FeedCompart feeds[];
+extern ThermoCooler cooler;
+extern TempSensor temps;
+extern PeltierDriver peltier;
+extern MenuSystem ms;
+extern CrashLog crashLog;
+extern ClockSync clockSync;
+extern WifiServer webServer;
+extern Scheduler ts;
+extern Task tClockSync;
+
+// Set by shellFail()
+bool shellFailed = false;
+
+void serviceSerial();
+void shellExecute(char *line);
+uint8_t shellParseNums(const char *str, uint16_t *out, uint8_t max);
+int8_t shellParseFeed(const char *str);
+uint8_t shellMonthDays(uint16_t year, uint8_t month);
+bool shellFail(const char *msg);
+
+bool shellHelp(uint8_t argc, char **argv);
+bool shellTime(uint8_t argc, char **argv);
+bool shellSync(uint8_t argc, char **argv);
+bool shellFeed(uint8_t argc, char **argv);
+bool shellTemp(uint8_t argc, char **argv);
+bool shellStats(uint8_t argc, char **argv);
+bool shellSettings(uint8_t argc, char **argv);
+bool shellCrash(uint8_t argc, char **argv);
+bool shellMenu(uint8_t argc, char **argv);
+// In Bench.h
+bool shellBench(uint8_t argc, char **argv);
+
+const ShellCommand shellCommands[] PROGMEM = {
+    { "help", &shellHelp, "" },
+    { "h", &shellHelp, "" },
+    { "?", &shellHelp, "" },
+    { "time", &shellTime, "[YYYY-MM-DD HH:MM:SS]" },
+    // Host sends its unix time (and ms) as it writes the line, for scripts
+    { "sync", &shellSync, "<unix secs> [ms]" },
+    { "feed", &shellFeed, "<n> [on|off] [<day> <HH:MM>]" },
+    { "temp", &shellTemp, "[set temp F]" },
+    { "stats", &shellStats, "" },
+    { "settings", &shellSettings, "" },
+    { "crash", &shellCrash, "" },
+    { "bench", &shellBench, "[name]" },
+    // Single letter menu navigation, like the old one key interface
+    { "w", &shellMenu, "(menu up)" },
+    { "s", &shellMenu, "(menu down)" },
+    { "a", &shellMenu, "(menu back)" },
+    { "d", &shellMenu, "(menu select)" },
+};
+
+void serviceSerial()
+{
+    TRACE_TASK();
+    static char line[SHELL_LINE_SIZE];
+    static uint8_t len = 0;
+    static bool overflow = false;
+
+    // Drain everything that arrived since the last pass
+    while (Serial.available() > 0)
+    {
+        char c = Serial.read();
+
+        if (c == '\r' || c == '\n') {
+            if (overflow) {
+                shellPrintf(PSTR("ERR line too long"));
+            } else if (len) {
+                line[len] = '\0';
+                shellExecute(line);
+            }
+            len = 0;
+            overflow = false;
+        } else if (c == '\b' || c == 0x7F) {
+            if (len) len--;
+        } else if (len < sizeof(line) - 1) {
+            line[len++] = c;
+        } else {
+            overflow = true;
+        }
+    }
+}
+
+// Splits the line in place and runs the matching command
+void shellExecute(char *line)
+{
+    char *argv[SHELL_MAX_ARGS];
+    uint8_t argc = 0;
+    char *tok = line;
+
+    while (*tok && argc < SHELL_MAX_ARGS)
+    {
+        while (*tok == ' ' || *tok == '\t') *tok++ = '\0';
+        if (!*tok) break;
+        argv[argc++] = tok;
+        while (*tok && *tok != ' ' && *tok != '\t') tok++;
+    }
+    if (!argc) return;
+
+    ShellCommand cmd;
+    for (uint8_t i = 0; i < sizeof(shellCommands) / sizeof(shellCommands[0]); i++)
+    {
+        memcpy_P(&cmd, &shellCommands[i], sizeof(cmd));
+        if (strcmp(cmd.name, argv[0])) continue;
+
+        shellFailed = false;
+        bool ok = cmd.fn(argc, argv);
+        // It already said what went wrong
+        if (shellFailed) return;
+        if (ok) {
+            shellPrintf(PSTR("OK"));
+        } else {
+            shellPrintf(PSTR("ERR usage: %s %s"), cmd.name, cmd.help);
+        }
+        return;
+    }
+    shellPrintf(PSTR("ERR unknown command '%s', try help"), argv[0]);
+}
+
+// Reads up to max unsigned numbers separated by anything that is not a digit
+uint8_t shellParseNums(const char *str, uint16_t *out, uint8_t max)
+{
+    uint8_t n = 0;
+
+    while (*str && n < max)
+    {
+        if (!isdigit(*str)) {
+            str++;
+            continue;
+        }
+        out[n] = 0;
+        while (isdigit(*str)) out[n] = out[n]*10 + (*str++ - '0');
+        n++;
+    }
+    return n;
+}
+
+uint8_t shellMonthDays(uint16_t year, uint8_t month)
+{
+    if (month == 2) return !(year % 4) && ((year % 100) || !(year % 400)) ? 29 : 28;
+    return month == 4 || month == 6 || month == 9 || month == 11 ? 30 : 31;
+}
+
+// For a command that got good arguments but could not do its job,
+// return shellFail(PSTR("ERR ...")) so neither OK nor the usage follows
+bool shellFail(const char *msg)
+{
+    shellPrintf(msg);
+    shellFailed = true;
+    return false;
+}
+
+// Feed numbers are 1 based on the command line, returns the index or -1
+int8_t shellParseFeed(const char *str)
+{
+    int n = atoi(str);
+    return (n >= 1 && n <= NUM_FEEDS) ? n - 1 : -1;
+}
+
+bool shellHelp(uint8_t argc, char **argv)
+{
+    ShellCommand cmd;
+    shellPrintf(PSTR("KittyFeeder " VERSION " commands:"));
+    for (uint8_t i = 0; i < sizeof(shellCommands) / sizeof(shellCommands[0]); i++)
+    {
+        memcpy_P(&cmd, &shellCommands[i], sizeof(cmd));
+        shellPrintf(PSTR("  %s %s"), cmd.name, cmd.help);
+    }
+    return true;
+}
+
+bool shellTime(uint8_t argc, char **argv)
+{
+    if (argc == 3) {
+        uint16_t date[3], clock[3] = {0, 0, 0};
+        if (shellParseNums(argv[1], date, 3) != 3 || shellParseNums(argv[2], clock, 3) < 2)
+            return false;
+        if (date[0] < 1970 || !date[1] || date[1] > 12 || !date[2]
+            || date[2] > shellMonthDays(date[0], date[1])
+            || clock[0] > 23 || clock[1] > 59 || clock[2] > 59)
+            return false;
+
+        tmElements_t tm;
+        tm.Year = CalendarYrToTm(date[0]);
+        tm.Month = date[1];
+        tm.Day = date[2];
+        tm.Hour = clock[0];
+        tm.Minute = clock[1];
+        tm.Second = clock[2];
+        time_t t = makeTime(tm);
+
+        if (RTC.set(t)) return shellFail(PSTR("ERR unable to set the RTC"));
+        setTime(t);
+        // Nothing was measured, don't let the next sync count this as drift
+        clockSync.invalidate();
+        LOG(LOG_DEBUG, "Time set over serial");
+    } else if (argc != 1) {
+        return false;
+    }
+
+    const tmElements_t &tm = timeSnapshot().Elements;
+    shellPrintf(PSTR("time %d-%02d-%02d %02d:%02d:%02d %s"), tmYearToCalendar(tm.Year), tm.Month,
+        tm.Day, tm.Hour, tm.Minute, tm.Second, dayShortStr(tm.Wday));
+    return true;
+}
+
+bool shellSync(uint8_t argc, char **argv)
+{
+    if (argc < 2 || argc > 3 || clockSync.isPending()) return false;
+
+    time_t t = strtoul(argv[1], NULL, 10);
+    uint16_t ms = argc == 3 ? atoi(argv[2]) : 0;
+    if (t < SECS_YR_2000 || ms > 999) return false;
+
+    // Result is printed once the RTC has been set on the host's next second
+    clockSync.request(t, ms);
+    tClockSync.enable();
+    return true;
+}
+
+bool shellFeed(uint8_t argc, char **argv)
+{
+    int8_t idx;
+    if (argc < 2 || (idx = shellParseFeed(argv[1])) < 0) return false;
+    FeedCompart &feed = feeds[idx];
+
+    if (argc == 3 && !strcmp_P(argv[2], PSTR("on"))) {
+        feed.enable();
+    } else if (argc == 3 && !strcmp_P(argv[2], PSTR("off"))) {
+        feed.disable();
+    } else if (argc == 4) {
+        uint16_t clock[2];
+        uint8_t wday = atoi(argv[2]);
+        // Take the day as a number (Sunday is 1) or its short name
+        for (uint8_t d = 1; !wday && d <= 7; d++)
+        {
+            if (!strncasecmp(argv[2], dayShortStr(d), 3)) wday = d;
+        }
+        if (wday < 1 || wday > 7 || shellParseNums(argv[3], clock, 2) != 2
+            || clock[0] > 23 || clock[1] > 59)
+            return false;
+
+        feed.setWeekDay(wday);
+        feed.setHour(clock[0]);
+        feed.setMin(clock[1]);
+    } else if (argc != 2) {
+        return false;
+    }
+
+    if (argc > 2) feed.saveSettingsToEE();
+    shellPrintf(PSTR("feed %d %s %s %02d:%02d"), idx + 1, feed.isEnabled() ? "on" : "off",
+        dayShortStr(feed.getWeekDay()), feed.getHour(), feed.getMin());
+    return true;
+}
+
+bool shellTemp(uint8_t argc, char **argv)
+{
+    if (argc == 2) {
+        int temp = atoi(argv[1]);
+        if (temp < MIN_COOLER_SET_TEMP || temp > MAX_COOLER_SET_TEMP) return false;
+        cooler.setTemp(temp);
+        cooler.saveSettingsToEE();
+    } else if (argc != 1) {
+        return false;
+    }
+
+    shellPrintf(PSTR("temp %dF set %dF pwm %d%% %s"), (int)round(cooler.getTemp()),
+        cooler.getSetTemp(), cooler.getPwmPercent(), cooler.isEnabled() ? "on" : "off");
+    return true;
+}
+
+bool shellStats(uint8_t argc, char **argv)
+{
+    shellPrintf(PSTR("uptime %lus"), millis() / 1000);
+    shellPrintf(PSTR("clock %s"), timeStatus() == timeSet ? "synced"
+        : timeStatus() == timeNeedsSync ? "needs sync" : "not set");
+    shellPrintf(PSTR("free_ram %d"), freeMemory());
+    shellPrintf(PSTR("rtc_offset %ldms interval %lus drift %ldppb"), clockSync.getOffset(),
+        clockSync.getInterval(), clockSync.getDriftPpb());
+    shellPrintf(PSTR("mcu_drift %ldppb"), clockSync.getMcuDriftPpb());
+    shellPrintf(PSTR("rtc_aging %d natural %ldppb samples %u"), clockSync.getAging(),
+        clockSync.getNaturalDriftPpb(), clockSync.getTrimSamples());
+    // Small values, so these get a decimal
+    int rate = round(cooler.getRate() * 10);
+    int offset = round(temps.getOffset() * 10);
+    shellPrintf(PSTR("temp %dF pwm %d%% rate %s%d.%dF/min confidence %d%%"), (int)round(cooler.getTemp()),
+        cooler.getPwmPercent(), rate < 0 ? "-" : "", abs(rate) / 10, abs(rate) % 10, cooler.getConfidence());
+    int coolRate = round(cooler.getCoolRate() * 10);
+    shellPrintf(PSTR("cooler target %dF cool_rate %d.%dF/min output %u/%u"), (int)round(cooler.getTarget()),
+        coolRate / 10, coolRate % 10, peltier.getLevel(), PD_TOP);
+    shellPrintf(PSTR("sensors fast %dF slow %dF rh %d%% offset %s%d.%dF %s"), (int)round(temps.getFastTemp()),
+        (int)round(temps.getSlowTemp()), (int)round(temps.getHumidity()), offset < 0 ? "-" : "",
+        abs(offset) / 10, abs(offset) % 10, temps.isCalibrated() ? "learned" : "none");
+    const WifiStatus &net = webServer.status();
+    shellPrintf(PSTR("wifi %s ip %s stations %d links %d age %lus"), net.up ? "up" : "down",
+        net.ip, net.stations, net.links, (millis() - net.updated) / 1000);
+    return true;
+}
+
+bool shellSettings(uint8_t argc, char **argv)
+{
+    shellPrintf(PSTR("version " VERSION));
+    shellPrintf(PSTR("ssid " SSID));
+    shellPrintf(PSTR("rtc_sync %ds"), RTC_SYNC_INTERVAL);
+    shellPrintf(PSTR("last_sync %lu"), clockSync.getLastSync());
+    shellPrintf(PSTR("cooler_set %dF"), cooler.getSetTemp());
+    for (uint8_t i = 0; i < NUM_FEEDS; i++)
+    {
+        shellPrintf(PSTR("feed %d %s %s %02d:%02d"), i + 1, feeds[i].isEnabled() ? "on" : "off",
+            dayShortStr(feeds[i].getWeekDay()), feeds[i].getHour(), feeds[i].getMin());
+    }
+    return true;
+}
+
+bool shellCrash(uint8_t argc, char **argv)
+{
+    crashLog.report();
+    return true;
+}
+
+bool shellMenu(uint8_t argc, char **argv)
+{
+    switch (argv[0][0])
+    {
+        case 'w': // Previus item
+            ms.prev();
+            break;
+        case 's': // Next item
+            ms.next();
+            break;
+        case 'a': // Back presed
+            ms.back();
+            break;
+        case 'd': // Select presed
+            ms.select(false);
+            break;
+    }
+    uiChanged();
+    return true;
+}
+
+#endif
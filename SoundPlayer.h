@@ -3,6 +3,8 @@
 
 #include "toneAC2.h"
 #include "Arduino.h"
+#include "FastPin.h"
+#include "FeederConfig.h"
 
 #define MAX_NOTES 20
 
@@ -107,16 +109,18 @@ struct melody
     uint8_t len;
 };
 
+// Piezo between PIEZO_PIN1 and PIEZO_PIN2, driven push-pull
 class SoundPlayer
 {
+    typedef FastPin<PIEZO_PIN1> Pin1;
+    typedef FastPin<PIEZO_PIN2> Pin2;
+
 public:
     static struct melody boot;
     static struct melody open;
     static struct melody close;
-    SoundPlayer(int pin1, int pin2)
+    SoundPlayer()
     {
-        _pin1 = pin1;
-        _pin2 = pin2;
         _curr = NULL;
         _idx = 0;
     }
@@ -134,7 +138,7 @@ public:
                 _idx = 0;
             } else {
                 _start = millis();
-                toneAC2(_pin1, _pin2, _curr->notes[_idx], _curr->durr[_idx], true);
+                toneAC2(PIEZO_PIN1, PIEZO_PIN2, _curr->notes[_idx], _curr->durr[_idx], true);
             }
         }
     }
@@ -143,30 +147,29 @@ public:
     {
         _curr = m;
         _start = millis();
-        toneAC2(_pin1, _pin2, m->notes[0], m->durr[0], true);
+        toneAC2(PIEZO_PIN1, PIEZO_PIN2, m->notes[0], m->durr[0], true);
         _idx = 0;
 
     }
 
+    // Each step is one SBI/CBI, was ~330 cycles of pinMode/digitalWrite before the delay
     void click()
     {
-        pinMode(_pin1, OUTPUT);
-        pinMode(_pin2, OUTPUT);
+        Pin1::output();
+        Pin2::output();
 
-        digitalWrite(_pin1, LOW);
-        digitalWrite(_pin2, HIGH);
+        Pin1::low();
+        Pin2::high();
 
-        digitalWrite(_pin1, HIGH);
-        digitalWrite(_pin2, LOW);
+        Pin1::high();
+        Pin2::low();
         delayMicroseconds(100);
 
-        digitalWrite(_pin1, LOW);
-        digitalWrite(_pin2, HIGH);
+        Pin1::low();
+        Pin2::high();
     }
 
 private:
-    int _pin1;
-    int _pin2;
     const struct melody *_curr;
     unsigned long long _start;
     uint8_t _idx;
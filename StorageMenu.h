@@ -20,6 +20,14 @@ public:
     }
 
 
+    // For arrays of menus, set the name and callback before adding it
+    StorageMenu()
+    : Menu(NULL)
+    {
+        _stor = NULL;
+        _stor_len = 0;
+    }
+
     StorageMenu(const char* name, void (*callback)(Menu*) = NULL)
     : Menu(name, callback)
     {
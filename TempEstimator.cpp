@@ -0,0 +1,95 @@
+#include "TempEstimator.h"
+
+TempEstimator::TempEstimator()
+{
+    valid = false;
+    rejects = 0;
+    temp = 0;
+    tempFrac = 0;
+    rate = 0;
+    rateFrac = 0;
+    p00 = TE_MAX_VAR_TEMP;
+    p01 = 0;
+    p11 = TE_INIT_VAR_RATE;
+}
+
+void TempEstimator::predict(uint16_t dtMs)
+{
+    if (!valid) return;
+
+    // Minutes in Q16, unsigned since anything over 32767ms overflows int32_t
+    int32_t dt = ((uint32_t)dtMs << 16) / 60000;
+
+    // Shifting floors, which alone walks a flat or falling estimate down a
+    // step every predict. Carry what falls below 1/256 F to the next one.
+    int64_t step = (int64_t)rate * dt + tempFrac;
+    temp += step >> 16;
+    tempFrac = step & 0xFFFF;
+    // P = F P F' + Q with F = [1 dt; 0 1]
+    p00 += (((int64_t)2 * p01 + (((int64_t)p11 * dt) >> 16)) * dt) >> 16;
+    p00 += TE_Q_TEMP * dtMs / 1000;
+    p01 += ((int64_t)p11 * dt) >> 16;
+    p11 += TE_Q_RATE * dtMs / 1000;
+
+    // Long without readings, forget how the two relate rather than overflow
+    if (p00 > TE_MAX_VAR_TEMP || p11 > TE_MAX_VAR_RATE) {
+        p00 = MIN(p00, TE_MAX_VAR_TEMP);
+        p11 = MIN(p11, TE_MAX_VAR_RATE);
+        p01 = 0;
+    }
+}
+
+bool TempEstimator::update(double reading, double sigma)
+{
+    int32_t z = round(reading * TE_ONE);
+    int32_t var = round(sigma * sigma * TE_ONE * TE_ONE);
+    if (var < 1) var = 1;
+
+    if (!valid) {
+        reset(z, var);
+        return true;
+    }
+
+    int32_t s = p00 + var;
+    int32_t y = z - temp;
+    if ((int64_t)y * y > (int64_t)TE_GATE_SIGMAS * TE_GATE_SIGMAS * s) {
+        // A real jump keeps disagreeing, a glitch doesn't
+        if (++rejects >= TE_MAX_REJECTS) reset(z, var);
+        return false;
+    }
+    rejects = 0;
+
+    // K = [p00 p01] / s, written out so nothing but s is divided
+    // Once it is tracking the gains are small, the temperature's is ~0.05.
+    // Dividing straight to LSBs would drop every correction under ~20 of
+    // them and the rate swings to make up for it, so carry the fractions.
+    int64_t step = (((int64_t)y * p00) << 16) / s + tempFrac;
+    temp += step >> 16;
+    tempFrac = step & 0xFFFF;
+    step = (((int64_t)y * p01) << 16) / s + rateFrac;
+    rate += step >> 16;
+    rateFrac = step & 0xFFFF;
+    p11 -= (int64_t)p01 * p01 / s;
+    p01 = (int64_t)p01 * var / s;
+    p00 = (int64_t)p00 * var / s;
+    return true;
+}
+
+uint8_t TempEstimator::getConfidence()
+{
+    if (!valid) return 0;
+    return (uint32_t)100 * TE_CONF_VAR / (TE_CONF_VAR + p00);
+}
+
+void TempEstimator::reset(int32_t z, int32_t var)
+{
+    valid = true;
+    rejects = 0;
+    temp = z;
+    tempFrac = 0;
+    rate = 0;
+    rateFrac = 0;
+    p00 = var;
+    p01 = 0;
+    p11 = TE_INIT_VAR_RATE;
+}
@@ -0,0 +1,68 @@
+/*
+  TempEstimator.h - Two state Kalman filter for the cooler, tracks the
+  temperature and how fast it is changing in fixed point
+  Created by D. Aaron Wisner
+  Released into the public domain.
+
+  Temperatures are 1/256 F and rates 1/256 F per minute in int32_t, the
+  covariances are in the squares of those. Products go through int64_t,
+  only a handful per update at the cooler's 2Hz.
+*/
+#ifndef TEMP_ESTIMATOR_H
+#define TEMP_ESTIMATOR_H
+
+#include <Arduino.h>
+#include "FeederUtils.h"
+
+#define TE_ONE 256L
+// How much the temperature and its rate wander on their own per second,
+// as variances. About 0.02F and 0.1F/min per root second.
+#define TE_Q_TEMP 26L
+#define TE_Q_RATE 655L
+// The rate is unknown when starting over, about 2F/min
+#define TE_INIT_VAR_RATE (512L * 512L)
+// Coasting without readings stops growing the variance here, 8F and 4F/min
+#define TE_MAX_VAR_TEMP (2048L * 2048L)
+#define TE_MAX_VAR_RATE (1024L * 1024L)
+// Readings further than this many standard deviations from the estimate
+// are dropped, unless this many in a row disagree and it starts over
+#define TE_GATE_SIGMAS 4
+#define TE_MAX_REJECTS 6
+// Variance at which getConfidence() reads 50%, 1F
+#define TE_CONF_VAR (TE_ONE * TE_ONE)
+
+class TempEstimator
+{
+public:
+    TempEstimator();
+
+    // Moves the estimate dtMs forward along its rate, call before update()
+    void predict(uint16_t dtMs);
+    // Folds in a reading with the given standard deviation, both in F.
+    // Returns false if it was rejected as an outlier.
+    bool update(double temp, double sigma);
+
+    // No reading accepted yet
+    bool isValid() { return valid; }
+    double getTemp() { return (double)temp / TE_ONE; }
+    // F per minute
+    double getRate() { return (double)rate / TE_ONE; }
+    // 0-100, falls as readings are rejected or missing
+    uint8_t getConfidence();
+    uint8_t getRejects() { return rejects; }
+
+private:
+    bool valid;
+    uint8_t rejects;
+    int32_t temp;
+    // 1/65536 of temp's LSB left over from predict() and update()
+    uint16_t tempFrac;
+    int32_t rate;
+    // 1/65536 of rate's LSB left over from update()
+    uint16_t rateFrac;
+    int32_t p00, p01, p11;
+
+    void reset(int32_t z, int32_t var);
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "TempSensor.h"
+
+TempSensor::TempSensor(double (*fast)(), bool (*slow)(double &temp, double &humidity),
+    unsigned long slowInterval)
+: fast(fast), slow(slow), slowInterval(slowInterval)
+{
+    lastSlow = 0;
+    temp = 0;
+    humidity = 0;
+    fastTemp = 0;
+    slowTemp = 0;
+    offset = 0;
+    sigma = TS_SLOW_SIGMA;
+    fastOk = false;
+    fresh = false;
+    calibrated = false;
+}
+
+void TempSensor::begin()
+{
+    lastSlow = millis() - slowInterval + TS_SLOW_WARMUP;
+    service();
+    if (!fastOk) LOG(LOG_ERROR, "Temp: Fast sensor not answering, using the slow one only");
+}
+
+bool TempSensor::service()
+{
+    double f = (*fast)();
+    fastOk = !isnan(f);
+    fresh = fastOk;
+    if (fastOk) {
+        fastTemp = f;
+        // Until the first slow sample the offset is a guess of 0
+        temp = fastTemp + offset;
+        sigma = calibrated ? TS_FAST_SIGMA : TS_UNCALIBRATED_SIGMA;
+    }
+
+    if (millis() - lastSlow < slowInterval) return false;
+    sampleSlow();
+    return true;
+}
+
+void TempSensor::sampleSlow()
+{
+    double t, h;
+
+    lastSlow = millis();
+    if (!(*slow)(t, h)) {
+        LOG(LOG_ERROR, "Temp: Unable to read the slow sensor");
+        return;
+    }
+    slowTemp = t;
+    humidity = h;
+
+    if (!fastOk) {
+        temp = slowTemp;
+        sigma = TS_SLOW_SIGMA;
+        fresh = true;
+        return;
+    }
+
+    // Both were read within a few ms, so all of the difference is the sensors
+    double measured = slowTemp - fastTemp;
+    if (!calibrated) {
+        offset = measured;
+        calibrated = true;
+        LOG(LOG_DEBUG, "Temp: Fast sensor reads %dF, slow %dF", (int)round(fastTemp), (int)round(slowTemp));
+    } else {
+        offset += (measured - offset) / TS_OFFSET_SMOOTHING;
+    }
+    temp = fastTemp + offset;
+    sigma = TS_FAST_SIGMA;
+}
+
+bool TempSensor::read(double &t, double &s)
+{
+    t = temp;
+    s = sigma;
+    // Each sample is only worth feeding to the estimator once
+    bool was = fresh;
+    fresh = false;
+    return was;
+}
@@ -0,0 +1,72 @@
+/*
+  TempSensor.h - Combines a fast but coarse temperature sensor with a slow
+  accurate one, the fast one is read every pass and corrected by an offset
+  learned from the slow one
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef TEMP_SENSOR_H
+#define TEMP_SENSOR_H
+
+#include <Arduino.h>
+#include "FeederUtils.h"
+
+// Each slow sample moves the offset 1/TS_OFFSET_SMOOTHING of the way to
+// what it measured, so one noisy DHT read can't throw it off
+#define TS_OFFSET_SMOOTHING 8
+// Standard deviation of each kind of reading in F, for whoever filters
+// them. The DS3232 steps in 0.45F, the DHT22 is good to about 0.5C.
+#define TS_FAST_SIGMA 0.5
+#define TS_UNCALIBRATED_SIGMA 3.0
+#define TS_SLOW_SIGMA 0.9
+// The DHT22 needs this long after power up before its first read
+#define TS_SLOW_WARMUP 2000
+
+class TempSensor
+{
+public:
+    // fast returns F or NAN on failure and must not block, slow fills in F
+    // and %RH and returns false on failure
+    TempSensor(double (*fast)(), bool (*slow)(double &temp, double &humidity),
+        unsigned long slowInterval);
+
+    // Reads the fast sensor and takes the first slow sample TS_SLOW_WARMUP
+    // ms later, rather than slowInterval, so the offset is known early
+    void begin();
+    // Reads the fast sensor, and the slow one once slowInterval is up.
+    // Returns true when the slow one was read, good or not.
+    bool service();
+
+    // Fast reading plus the offset, the slow reading alone if the fast
+    // sensor is not answering. Holds the last good value through failures.
+    double getTemp() { return temp; }
+    // The reading the last service() took and how far to trust it, false if
+    // neither sensor answered or it was already read
+    bool read(double &t, double &s);
+    double getHumidity() { return humidity; }
+    double getFastTemp() { return fastTemp; }
+    double getSlowTemp() { return slowTemp; }
+    // Slow minus fast, valid once isCalibrated()
+    double getOffset() { return offset; }
+    bool isCalibrated() { return calibrated; }
+
+private:
+    double (*fast)();
+    bool (*slow)(double &temp, double &humidity);
+    const unsigned long slowInterval;
+    unsigned long lastSlow;
+
+    double temp;
+    double humidity;
+    double fastTemp;
+    double slowTemp;
+    double offset;
+    double sigma;
+    bool fastOk;
+    bool fresh;
+    bool calibrated;
+
+    void sampleSlow();
+};
+
+#endif
@@ -1,53 +1,118 @@
 #include "ThermoCooler.h"
 
 
-ThermoCooler::ThermoCooler(int16_t pin, double (*gettemp)(), uint16_t eepromLoc)
-: pin(pin), eepromLoc(eepromLoc), gettemp(gettemp)
+ThermoCooler::ThermoCooler(void (*setPwm)(uint8_t), bool (*gettemp)(double &temp, double &sigma), uint16_t eepromLoc)
+: eepromLoc(eepromLoc), setPwm(setPwm), gettemp(gettemp)
 {
     enabled = false;
     pwmPercent = 0;
-    pinMode(pin, OUTPUT);
-
+    lastService = 0;
+    blind = false;
+    nextFeed = TC_NO_FEED;
+    maxFloat = 0;
+    coolRate = TC_DEFAULT_COOL_RATE;
+    fullSince = 0;
 }
 
 void ThermoCooler::begin()
 {
     if (!loadSettingsFromEE()) {
-        last_temp = 0;
         settings.set_temp = 40;
+        settings.cool_rate = TC_DEFAULT_COOL_RATE;
         saveSettingsToEE();
         LOG(LOG_ERROR, "Cooler: Failed to load set temp from EEPROM");
     } else {
         LOG(LOG_DEBUG, "Cooler: Loaded set temp of %dF from EEPROM", settings.set_temp);
     }
+    // Written before the rate was kept, or never learned
+    if (!(settings.cool_rate >= TC_MIN_COOL_RATE && settings.cool_rate <= TC_MAX_COOL_RATE)) {
+        settings.cool_rate = TC_DEFAULT_COOL_RATE;
+    }
+    coolRate = settings.cool_rate;
 
         service();
 }
 
 void ThermoCooler::service()
 {
-    // Simple low pass filter
-    double current = ( (*gettemp)() + last_temp)/2.0;
-    double delta = current - settings.set_temp;
+    unsigned long ms = millis();
+    double reading, sigma;
+
+    est.predict(MIN(ms - lastService, 60000UL));
+    lastService = ms;
+    if ((*gettemp)(reading, sigma) && !est.update(reading, sigma)) {
+        LOG(LOG_DEBUG, "Cooler: Ignored a reading of %dF", (int)round(reading));
+    }
+
+    double current = est.getTemp();
+    double target = getTarget();
+    double delta = current - target;
+
+    // Readings stopped or keep getting rejected
+    if (enabled && est.getConfidence() < TC_MIN_CONFIDENCE) {
+        if (!blind) LOG(LOG_ERROR, "Cooler: No trustworthy temperature, stopping");
+        blind = true;
+        setPwm(0);
+        pwmPercent = 0;
+        fullSince = 0;
+        return;
+    }
+    blind = false;
 
     if (!enabled) {
-        digitalWrite(pin, 0);
+        setPwm(0);
         pwmPercent = 0;
-    } else if (current > settings.set_temp + TC_PWM_DELTA_DEG) {
+    } else if (current > target + TC_PWM_DELTA_DEG) {
         // It is over TC_PWM_DELTA_DEG away from set temp
-        digitalWrite(pin, 1);
+        setPwm(255);
         pwmPercent = 100;
-    } else if (current > settings.set_temp - TC_PWM_DELTA_DEG) {
+    } else if (current > target - TC_PWM_DELTA_DEG) {
         // It is within TC_PWM_DELTA_DEG, so start using pwm
         double pwm = round(128 + (127*delta)/TC_PWM_DELTA_DEG);
         pwmPercent = (uint16_t)round((pwm*100)/255);
-        analogWrite(pin, (int)pwm);
+        setPwm((uint8_t)pwm);
     } else {
-        digitalWrite(pin, 0);
+        setPwm(0);
         pwmPercent = 0;
     }
+    learnCoolRate(pwmPercent == 100);
+}
+
+// Holds the set temp while a door is open or nothing is scheduled. Before
+// that it lets the temperature float as high as it could still be pulled
+// back from by the time the door opens, so the cooler mostly runs right
+// before a feed instead of all day.
+double ThermoCooler::getTarget()
+{
+    if (nextFeed <= 0 || !maxFloat) return settings.set_temp;
+
+    double reach = coolRate * TC_PRECOOL_MARGIN * nextFeed / 60.0;
+    return settings.set_temp + MIN(reach, (double)maxFloat);
+}
+
+// The estimator's rate at full power is how fast this box cools with
+// whatever is in it and whatever the room is doing
+void ThermoCooler::learnCoolRate(bool fullPower)
+{
+    unsigned long ms = millis();
+
+    if (!fullPower || est.getConfidence() < 50) {
+        fullSince = 0;
+        return;
+    }
+    if (!fullSince) fullSince = ms;
+    if (ms - fullSince < TC_RATE_SETTLE_MS) return;
+
+    // Each rate is noisy, about 0.2F/min, so only the smoothed value gets the
+    // floor. Flooring samples would read a slow box as faster than it is.
+    double measured = MIN(-est.getRate(), TC_MAX_COOL_RATE);
+    coolRate += (measured - coolRate) / TC_RATE_SMOOTHING;
+    coolRate = MAX(coolRate, TC_MIN_COOL_RATE);
 
-    last_temp = current;
+    if (fabs(coolRate - settings.cool_rate) > TC_RATE_SAVE_DELTA) {
+        settings.cool_rate = coolRate;
+        saveSettingsToEE();
+    }
 }
 
 void ThermoCooler::setTemp(int temp)
@@ -60,7 +125,7 @@ bool ThermoCooler::loadSettingsFromEE()
     // Copy everything
     for (int i=0; i < THERMO_COOLER_EE_SIZE; i++)
     {
-        ((unsigned char*)&settings)[i] = EEPROM[i];
+        ((unsigned char*)&settings)[i] = EEPROM[eepromLoc + i];
     }
 
     return settings.crc == generateCrc();
@@ -77,7 +142,8 @@ void ThermoCooler::saveSettingsToEE()
     // Copy everything
     for (int i=0; i < THERMO_COOLER_EE_SIZE; i++)
     {
-        EEPROM[i] = ((char*)&settings)[i];
+        // Learning the rate saves on its own, only wear what changed
+        EEPROM.update(eepromLoc + i, ((unsigned char*)&settings)[i]);
     }
     LOG(LOG_DEBUG, "Cooler: Settings saved to EEPROM");
 }
@@ -98,7 +164,7 @@ uint16_t ThermoCooler::getPwmPercent()
 
 double ThermoCooler::getTemp()
 {
-    return last_temp;
+    return est.getTemp();
 }
 
 int ThermoCooler::getSetTemp()
@@ -10,15 +10,35 @@
 #include <Arduino.h>
 #include "EEPROM.h"
 #include "FeederUtils.h"
+#include "TempEstimator.h"
 
 // How many degrees from set temp to start using pwm
 #define TC_PWM_DELTA_DEG 1
+// Below this estimator confidence the cooler stops rather than run blind
+#define TC_MIN_CONFIDENCE 20
+// Pre-cooling plans on this much of the learned cooling rate, so it starts early
+#define TC_PRECOOL_MARGIN 0.7
+// F per minute at full power, assumed until one is measured and bounds on what is learned
+#define TC_DEFAULT_COOL_RATE 0.5
+#define TC_MIN_COOL_RATE 0.1
+#define TC_MAX_COOL_RATE 5.0
+// Full power for this many ms before its rate is learned from, past the start up transient
+#define TC_RATE_SETTLE_MS 60000
+// Each pass at full power moves the cooling rate 1/TC_RATE_SMOOTHING of the way
+#define TC_RATE_SMOOTHING 128
+// Learned rate is saved once it moves this far from the one in EEPROM,
+// a few times a day at most once it has settled
+#define TC_RATE_SAVE_DELTA 0.05
+// No door opening is coming
+#define TC_NO_FEED (-1L)
 #define THERMO_COOLER_EE_SIZE (sizeof(EEThermoCoolerSettings))
 
 // Make a struct so we can memcpy it out of EEPROM
 typedef struct EEThermoCoolerSettings
 {
     int set_temp;
+    // Learned F per minute at full power, so a reboot doesn't start from a guess
+    float cool_rate;
     uint32_t crc;
 } EEThermoCoolerSettings;
 
@@ -26,15 +46,31 @@ class ThermoCooler
 {
 
 public:
-    ThermoCooler(int16_t pin, double (*gettemp)(), uint16_t eepromLoc);
+    // setPwm drives the peltier, 0 is off and 255 fully on. gettemp returns
+    // false when there is no new reading, otherwise the reading and its
+    // standard deviation in F.
+    ThermoCooler(void (*setPwm)(uint8_t), bool (*gettemp)(double &temp, double &sigma), uint16_t eepromLoc);
 
     void service();
+    // Filtered, what the cooler acts on
     double getTemp();
+    // F per minute
+    double getRate() { return est.getRate(); }
+    uint8_t getConfidence() { return est.getConfidence(); }
     int getSetTemp();
     void disable();
     void enable();
     void begin();
     void setTemp(int temp);
+    // Seconds until the next door opens, TC_NO_FEED if none is scheduled
+    void setNextFeed(long secs) { nextFeed = secs; }
+    // Degrees over the set temp it may drift to while the next feed is
+    // far off, 0 holds the set temp all the time
+    void setMaxFloat(uint8_t deg) { maxFloat = deg; }
+    // What it is cooling to right now, the set temp unless pre-cooling
+    double getTarget();
+    // Learned F per minute at full power
+    double getCoolRate() { return coolRate; }
     uint16_t getPwmPercent();
     bool isEnabled();
     void saveSettingsToEE();
@@ -43,11 +79,19 @@ private:
     bool enabled;
     EEThermoCoolerSettings settings;
     const uint16_t eepromLoc;
-    double last_temp;
-    const int16_t pin;
-    double (*gettemp)();
+    TempEstimator est;
+    unsigned long lastService;
+    bool blind;
+    long nextFeed;
+    uint8_t maxFloat;
+    double coolRate;
+    // When the current stretch of full power started, 0 if not at full power
+    unsigned long fullSince;
+    void (*setPwm)(uint8_t);
+    bool (*gettemp)(double &temp, double &sigma);
     uint16_t pwmPercent;
 
+    void learnCoolRate(bool fullPower);
     bool loadSettingsFromEE();
     uint32_t generateCrc();
 };
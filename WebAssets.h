@@ -0,0 +1,130 @@
+/*
+  WebAssets.h - Gzipped web interface, generated by tools/webassets.py
+  from web/ for v2.0, do not edit by hand
+*/
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+
+#define WEB_ASSET_PATH_SIZE 24
+#define WEB_ASSET_TYPE_SIZE 24
+#define WEB_ASSET_ETAG_SIZE 24
+
+// Lives in flash, data is always gzip encoded
+typedef struct WebAsset
+{
+    char path[WEB_ASSET_PATH_SIZE];
+    char type[WEB_ASSET_TYPE_SIZE];
+    char etag[WEB_ASSET_ETAG_SIZE];
+    const uint8_t *data;
+    uint16_t len;
+} WebAsset;
+
+// index.html, 424 bytes gzipped
+const uint8_t web_index_html[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7d, 0x92, 0x4f, 0x6f, 0xd4, 0x30,
+    0x10, 0xc5, 0xef, 0xf9, 0x14, 0xc6, 0x12, 0x3d, 0x35, 0x31, 0xcd, 0x85, 0x3f, 0x75, 0x7c, 0x29,
+    0x2c, 0x48, 0x3d, 0x50, 0x89, 0xf6, 0xc0, 0xd1, 0x6b, 0x0f, 0x9b, 0xa1, 0x8e, 0x63, 0xd9, 0x93,
+    0x8d, 0x96, 0x4f, 0x8f, 0x9d, 0x4d, 0x68, 0x0b, 0x12, 0xa7, 0x49, 0x9e, 0xe6, 0xfd, 0xfc, 0x3c,
+    0x63, 0xf9, 0xea, 0xe3, 0xd7, 0x9b, 0xfb, 0xef, 0x77, 0x9f, 0x58, 0x4f, 0x83, 0x53, 0x95, 0xdc,
+    0x0a, 0x68, 0x9b, 0xcb, 0x00, 0xa4, 0x99, 0xe9, 0x75, 0x4c, 0x40, 0x1d, 0x7f, 0xb8, 0xdf, 0xd5,
+    0xef, 0xf8, 0x26, 0x7b, 0x3d, 0x40, 0xc7, 0x8f, 0x08, 0x73, 0x18, 0x23, 0x71, 0x66, 0x46, 0x4f,
+    0xe0, 0x73, 0xdb, 0x8c, 0x96, 0xfa, 0xce, 0xc2, 0x11, 0x0d, 0xd4, 0xcb, 0xcf, 0x25, 0x43, 0x8f,
+    0x84, 0xda, 0xd5, 0xc9, 0x68, 0x07, 0xdd, 0x55, 0x81, 0x10, 0x92, 0x03, 0x75, 0x8b, 0x44, 0x27,
+    0xb6, 0x03, 0xb0, 0x10, 0x59, 0x7b, 0x2b, 0xc5, 0x59, 0xae, 0xa4, 0x43, 0xff, 0xc8, 0x22, 0xb8,
+    0x8e, 0x27, 0x3a, 0x39, 0x48, 0x3d, 0x40, 0x3e, 0xa4, 0x8f, 0xf0, 0xa3, 0xe3, 0x42, 0x87, 0xd0,
+    0x98, 0x94, 0x0a, 0x46, 0xac, 0x51, 0xf7, 0xa3, 0x3d, 0x95, 0xe0, 0x57, 0xff, 0x22, 0xb3, 0x56,
+    0x49, 0x8b, 0x47, 0x66, 0x9c, 0x4e, 0xa9, 0xe3, 0x46, 0x47, 0x9b, 0x38, 0x43, 0xbb, 0x7d, 0xaa,
+    0x8a, 0xb1, 0xbf, 0x1b, 0xb8, 0x92, 0x7d, 0xab, 0x6e, 0xdc, 0x68, 0x1e, 0x33, 0xa1, 0x55, 0x32,
+    0x2c, 0x06, 0xc2, 0x01, 0xb8, 0xaa, 0x6b, 0x29, 0x82, 0x92, 0x22, 0x7b, 0xfe, 0xe3, 0x1d, 0x47,
+    0x07, 0x71, 0x35, 0x2b, 0x99, 0x82, 0xf6, 0x67, 0x04, 0x0c, 0xe1, 0x8c, 0x28, 0x92, 0xba, 0xb0,
+    0x70, 0xb8, 0xde, 0x2d, 0xbc, 0xb0, 0x41, 0xd2, 0xb4, 0xe7, 0xea, 0x0e, 0x1c, 0x61, 0xbe, 0x82,
+    0x26, 0xf6, 0x64, 0x0e, 0xf3, 0xf0, 0xcc, 0xfb, 0xfa, 0x59, 0x8c, 0xad, 0xbc, 0x84, 0x94, 0x74,
+    0x7f, 0xcc, 0x79, 0x45, 0x9e, 0xe7, 0x5c, 0xde, 0x83, 0x21, 0xf4, 0x87, 0xa6, 0x69, 0x56, 0x10,
+    0xbb, 0x18, 0xd0, 0xda, 0x91, 0xae, 0x4b, 0xbf, 0xde, 0xc6, 0x9c, 0x48, 0xd3, 0x94, 0xc7, 0xf3,
+    0xcd, 0xf4, 0x60, 0x27, 0x07, 0x4c, 0x7b, 0xcb, 0xf2, 0x53, 0x28, 0xde, 0x24, 0x85, 0x7e, 0x61,
+    0xdb, 0x61, 0x1c, 0x66, 0x1d, 0x81, 0x1d, 0xdb, 0xe6, 0xcd, 0xe5, 0x13, 0xa5, 0x27, 0x0a, 0xe9,
+    0x83, 0x10, 0x07, 0xa4, 0x7e, 0xda, 0x37, 0x66, 0x1c, 0xc4, 0x8c, 0xbf, 0xf2, 0x94, 0xde, 0xbf,
+    0x15, 0xcb, 0xaa, 0xce, 0x9b, 0x6a, 0xb9, 0x9a, 0x82, 0xd5, 0x04, 0x89, 0x8d, 0x9e, 0x7d, 0x46,
+    0xfa, 0x32, 0xed, 0xcb, 0x11, 0x55, 0xb9, 0x62, 0x25, 0x93, 0x89, 0x18, 0x88, 0xa5, 0x68, 0xd6,
+    0xf5, 0xff, 0xcc, 0xb9, 0x72, 0xf8, 0x45, 0x2e, 0x4d, 0xeb, 0xfe, 0xc5, 0xf9, 0x01, 0xff, 0x06,
+    0xa2, 0x5c, 0x57, 0xdb, 0xd8, 0x02, 0x00, 0x00,
+};
+
+// app.css, 258 bytes gzipped
+const uint8_t web_app_css[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x6d, 0x50, 0xed, 0x6e, 0x85, 0x20,
+    0x0c, 0xfd, 0xef, 0x53, 0x34, 0xd9, 0x9f, 0x2d, 0xb9, 0x10, 0x64, 0xc6, 0x64, 0xdc, 0xa7, 0x29,
+    0x22, 0x4a, 0xa6, 0x42, 0x40, 0x23, 0x77, 0xcb, 0x7d, 0xf7, 0x81, 0x6e, 0xf1, 0x7e, 0x2c, 0x05,
+    0x9a, 0x9e, 0xb6, 0x87, 0xd3, 0x4a, 0xab, 0x2e, 0xf0, 0x5d, 0x00, 0x68, 0x3b, 0xcd, 0x44, 0xe3,
+    0x68, 0x86, 0x8b, 0x80, 0x80, 0x53, 0x20, 0xa1, 0xf5, 0x46, 0x9f, 0x53, 0x6a, 0x44, 0xdf, 0x99,
+    0x49, 0x00, 0x03, 0x5c, 0x66, 0xbb, 0x23, 0x91, 0xac, 0x46, 0xcd, 0xbd, 0x80, 0x8a, 0xb5, 0x63,
+    0x86, 0x1c, 0x2a, 0x65, 0xa6, 0x4e, 0x40, 0xb9, 0xc7, 0x8d, 0x1d, 0xac, 0x17, 0xf0, 0xc2, 0x39,
+    0xcf, 0xa1, 0xc4, 0xe6, 0xb3, 0xf3, 0x76, 0x99, 0x54, 0xc2, 0x74, 0x95, 0xed, 0x5c, 0x5c, 0x8b,
+    0xbe, 0x3c, 0x3e, 0x0f, 0xe6, 0xab, 0x4d, 0xed, 0xb4, 0xce, 0x04, 0xd7, 0x82, 0x36, 0xe8, 0x55,
+    0xd8, 0xd2, 0xca, 0x04, 0x37, 0x60, 0xd2, 0xa5, 0x87, 0x36, 0x66, 0xb6, 0xec, 0xc9, 0xea, 0xd1,
+    0x09, 0xc8, 0x6f, 0x86, 0xba, 0x1c, 0x94, 0x37, 0xad, 0x3b, 0x71, 0x2a, 0x4c, 0x70, 0x36, 0xfe,
+    0xa0, 0x93, 0xfd, 0x29, 0xbd, 0x97, 0xa6, 0xb7, 0x91, 0xa5, 0xf5, 0xaa, 0xf5, 0xc4, 0xa3, 0x32,
+    0x4b, 0x10, 0x50, 0xbb, 0xb8, 0xa3, 0x91, 0x84, 0x1e, 0x95, 0x5d, 0xb7, 0x76, 0x17, 0xe1, 0x3d,
+    0x5d, 0xdf, 0x49, 0x7c, 0x65, 0x27, 0xf8, 0x3d, 0x94, 0xbf, 0x1d, 0x1a, 0x7a, 0xfe, 0x34, 0xdf,
+    0xfd, 0x7a, 0xea, 0xba, 0x3e, 0xaa, 0xdd, 0xf3, 0x32, 0xaa, 0xdb, 0x89, 0x1c, 0x0d, 0x8b, 0x3c,
+    0xed, 0xee, 0xb1, 0x94, 0xd1, 0x8f, 0x7f, 0x99, 0x7f, 0x00, 0xf5, 0x6f, 0x46, 0xbd, 0xe1, 0x01,
+    0x00, 0x00,
+};
+
+// app.js, 689 bytes gzipped
+const uint8_t web_app_js[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x54, 0xc1, 0x6e, 0xdb, 0x30,
+    0x0c, 0xbd, 0xf7, 0x2b, 0xb8, 0xee, 0x20, 0x05, 0x4b, 0xed, 0xb6, 0xbb, 0xb5, 0x49, 0x06, 0xac,
+    0xcb, 0xb0, 0x0d, 0x5d, 0x07, 0xac, 0xbd, 0x15, 0x39, 0x08, 0x36, 0x13, 0x0b, 0xb1, 0x25, 0x41,
+    0x52, 0x92, 0x05, 0x45, 0xfe, 0x7d, 0xa4, 0xec, 0x24, 0x6e, 0x0e, 0x45, 0x0f, 0x91, 0x23, 0x91,
+    0x7c, 0xe2, 0x7b, 0x7e, 0x74, 0x9e, 0xc3, 0x74, 0x8d, 0x7e, 0x1b, 0x2b, 0x6d, 0x16, 0x60, 0x0d,
+    0xc4, 0x0a, 0xc1, 0xa9, 0x05, 0x42, 0x61, 0x1b, 0x0c, 0x30, 0xf7, 0xb6, 0x81, 0x1c, 0xd7, 0x68,
+    0x62, 0x18, 0xa6, 0xe0, 0x5c, 0xfb, 0x10, 0x81, 0x62, 0x81, 0xb3, 0x94, 0xf7, 0x7a, 0x8d, 0xe1,
+    0x2c, 0xcf, 0x41, 0x05, 0x08, 0x96, 0x10, 0xe8, 0xa9, 0x23, 0x95, 0x1b, 0x83, 0x45, 0x0c, 0xa0,
+    0x4c, 0x99, 0xea, 0x3c, 0x52, 0x99, 0x35, 0xf5, 0x16, 0x36, 0x15, 0x1a, 0x4a, 0x6d, 0xb0, 0xbd,
+    0xb4, 0xa8, 0x94, 0x59, 0x10, 0x84, 0x9c, 0xaf, 0x4c, 0x11, 0x35, 0x21, 0xc8, 0x01, 0xbc, 0x9c,
+    0x01, 0xac, 0x95, 0x4f, 0x30, 0x30, 0x86, 0xd2, 0x16, 0xab, 0x86, 0x7a, 0xc8, 0x16, 0x18, 0xa7,
+    0x35, 0xf2, 0xdf, 0xaf, 0xdb, 0x9f, 0xa5, 0x14, 0x1c, 0x17, 0x83, 0xdb, 0x7d, 0xb6, 0xf2, 0x65,
+    0x78, 0x33, 0x9d, 0x13, 0x8e, 0xf9, 0x2d, 0x2f, 0x2a, 0x30, 0xb8, 0x61, 0x1d, 0x4c, 0x7c, 0xb4,
+    0x2b, 0x5f, 0xa0, 0x14, 0x1d, 0x65, 0x4e, 0xa5, 0x5c, 0x62, 0xf7, 0xb4, 0xd7, 0xa5, 0xb4, 0x18,
+    0x8c, 0x88, 0xb0, 0x34, 0x76, 0x03, 0x15, 0xfd, 0x1a, 0x65, 0xb6, 0xac, 0x96, 0x53, 0x3e, 0x36,
+    0x09, 0x2f, 0xc9, 0x84, 0x58, 0xa2, 0x87, 0x4a, 0x91, 0x6c, 0xa8, 0x8a, 0x8a, 0xa8, 0x63, 0x8b,
+    0x44, 0x3d, 0x91, 0x2a, 0xa9, 0xd7, 0x9e, 0xa0, 0x51, 0x37, 0x48, 0xba, 0x05, 0xc2, 0xb7, 0x1e,
+    0x02, 0x01, 0x07, 0x58, 0x39, 0xaa, 0x38, 0xa8, 0xc2, 0x01, 0xa9, 0x5b, 0x69, 0xda, 0xf6, 0x75,
+    0x49, 0xad, 0x0b, 0x3e, 0x17, 0xf0, 0x09, 0xa4, 0xa6, 0xe5, 0x2a, 0x71, 0xeb, 0xd8, 0xd5, 0x6f,
+    0x48, 0xa1, 0xcb, 0x2e, 0x53, 0xcf, 0x41, 0x7e, 0xc0, 0x7a, 0x8f, 0x7b, 0x14, 0xb2, 0x5f, 0x5c,
+    0x78, 0x54, 0x11, 0xbb, 0x7a, 0x29, 0x4a, 0xbd, 0x16, 0x5d, 0x39, 0xa4, 0xdc, 0xac, 0xa8, 0x55,
+    0x08, 0x0f, 0x8a, 0x38, 0x50, 0x47, 0x7c, 0x22, 0x5e, 0x85, 0x35, 0x99, 0xc1, 0xff, 0x78, 0xfa,
+    0x7d, 0xcf, 0xe1, 0x51, 0x75, 0x3d, 0xf9, 0x4e, 0xf2, 0xc0, 0xc7, 0x5e, 0xdb, 0xb4, 0x88, 0x51,
+    0x4e, 0x91, 0x91, 0x9b, 0x7c, 0x63, 0x09, 0x46, 0xc1, 0x29, 0x43, 0x14, 0xc7, 0xe7, 0x9c, 0x45,
+    0x54, 0x29, 0xe1, 0x7c, 0x72, 0x71, 0x31, 0xca, 0x39, 0x30, 0x19, 0xe5, 0x6e, 0xf2, 0xea, 0x8e,
+    0x90, 0x29, 0xe7, 0xd0, 0x94, 0x77, 0x95, 0xae, 0x4b, 0xc9, 0x27, 0x87, 0x0e, 0xdf, 0x27, 0xc4,
+    0x2e, 0xad, 0x1e, 0xe3, 0xca, 0x1b, 0x2a, 0xe1, 0xc3, 0x1d, 0xbf, 0xfc, 0xd6, 0x09, 0x99, 0x35,
+    0x96, 0xe0, 0x09, 0xe8, 0xd4, 0xa6, 0x90, 0x4c, 0x9a, 0x45, 0xfc, 0x17, 0xef, 0xac, 0x89, 0x94,
+    0xcc, 0x24, 0xef, 0x69, 0x2c, 0x52, 0x7f, 0xbb, 0xdb, 0x3e, 0x06, 0x7a, 0x4f, 0xdc, 0xde, 0x0b,
+    0xf2, 0x17, 0xbb, 0x31, 0xa2, 0x39, 0xc9, 0xb2, 0xec, 0x88, 0x47, 0x36, 0x9a, 0xb2, 0xa9, 0xf6,
+    0x63, 0xa8, 0x03, 0x3c, 0xb3, 0x83, 0x68, 0x44, 0xb1, 0x71, 0x43, 0x70, 0x9b, 0x66, 0x98, 0x0c,
+    0x13, 0x66, 0xdd, 0x93, 0x1c, 0x27, 0xae, 0x04, 0x48, 0x26, 0x31, 0x00, 0xea, 0x41, 0x5c, 0x8a,
+    0x16, 0xc8, 0xa1, 0xef, 0xdb, 0x77, 0x08, 0x4b, 0x74, 0x91, 0x1d, 0xe8, 0x69, 0xd5, 0xa6, 0xc0,
+    0xe4, 0xd2, 0x5a, 0x9b, 0x25, 0x5f, 0x13, 0x6a, 0xbb, 0xe9, 0x13, 0xda, 0x77, 0xd0, 0xa7, 0x84,
+    0x7d, 0x93, 0x96, 0x2a, 0x2a, 0x8a, 0xfe, 0x7a, 0xfc, 0xf3, 0x90, 0xd1, 0x1d, 0x01, 0x25, 0x66,
+    0x7c, 0xd6, 0x33, 0xea, 0x5c, 0x63, 0x9d, 0xe6, 0xf6, 0x25, 0x8d, 0xc1, 0x4d, 0xaa, 0x79, 0xbe,
+    0x9c, 0xb5, 0x6c, 0xba, 0xed, 0xd5, 0x2c, 0xd1, 0xea, 0x76, 0xd7, 0xb3, 0x56, 0x08, 0x68, 0xb7,
+    0x9f, 0x67, 0x59, 0x70, 0xb5, 0x26, 0x6b, 0x8a, 0x41, 0x36, 0xb7, 0x9e, 0xc5, 0xe9, 0x7d, 0x4f,
+    0x98, 0xf4, 0x10, 0xf4, 0xd1, 0xe3, 0xdd, 0x2c, 0x9d, 0xe8, 0xdd, 0xbe, 0xe0, 0xf1, 0x38, 0x29,
+    0xf5, 0x05, 0x04, 0xef, 0x05, 0xdc, 0x90, 0xa1, 0x6b, 0x1b, 0x70, 0x6f, 0xe9, 0x5d, 0xd7, 0x39,
+    0x5d, 0x03, 0x92, 0xdb, 0x5f, 0xe2, 0x16, 0xb4, 0xe9, 0x58, 0xbc, 0x9e, 0xa3, 0x37, 0x9d, 0x47,
+    0x75, 0x07, 0x8b, 0xf2, 0x14, 0xf2, 0x10, 0x62, 0x7d, 0xd2, 0x53, 0x8b, 0xfa, 0x4c, 0xb9, 0xb3,
+    0xa3, 0x4d, 0x89, 0xfa, 0x6e, 0x20, 0xa9, 0xf8, 0x3f, 0xd6, 0x8c, 0x7a, 0x74, 0xbf, 0x05, 0x00,
+    0x00,
+};
+
+const WebAsset webAssets[] PROGMEM = {
+    { "/", "text/html", "\"v2.0-a2ff38e7\"", web_index_html, sizeof(web_index_html) },
+    { "/app.css", "text/css", "\"v2.0-e69a93e6\"", web_app_css, sizeof(web_app_css) },
+    { "/app.js", "application/javascript", "\"v2.0-524a5484\"", web_app_js, sizeof(web_app_js) },
+};
+
+#endif
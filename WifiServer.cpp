@@ -0,0 +1,521 @@
+#include "WifiServer.h"
+#include <string.h>
+
+// Same order as HttpHeader
+const char httpHeaderNames[HTTP_NUM_HEADERS][16] PROGMEM = {
+    "Accept-Encoding",
+    "If-None-Match",
+};
+
+// Answers with just the error status, nothing to route it to
+static int16_t httpError(WifiLink &link, char *buf, uint16_t size)
+{
+    if (link.part++) return WIFI_RESPONSE_DONE;
+
+    const char *reason;
+    switch (link.status)
+    {
+        case 400: reason = PSTR("Bad Request"); break;
+        case 404: reason = PSTR("Not Found"); break;
+        case 405: reason = PSTR("Method Not Allowed"); break;
+        case 414: reason = PSTR("URI Too Long"); break;
+        case 503: reason = PSTR("Service Unavailable"); break;
+        default: reason = PSTR("Error"); break;
+    }
+    return snprintf_P(buf, size, PSTR("HTTP/1.1 %u %S\r\nContent-Length: 0\r\n"
+        "Connection: close\r\n\r\n"), link.status, reason);
+}
+
+WifiServer::WifiServer(HardwareSerial &serial)
+: serial(serial)
+{
+    routes = NULL;
+    numRoutes = 0;
+    lineLen = 0;
+    ipdLink = 0;
+    ipdRemain = 0;
+    atState = AT_IDLE;
+    atLink = 0;
+    atStart = 0;
+    nextLink = 0;
+    chunkP = NULL;
+    chunkLen = 0;
+    written = 0;
+    memset(links, 0, sizeof(links));
+    memset(&netStatus, 0, sizeof(netStatus));
+    statusDue = false;
+    statusStart = 0;
+    stationCount = 0;
+}
+
+bool WifiServer::command(const __FlashStringHelper *cmd, long arg)
+{
+    serial.print(cmd);
+    if (arg >= 0) serial.print(arg);
+    serial.println();
+    return waitOk();
+}
+
+bool WifiServer::setBaud(uint32_t baud, bool flowControl)
+{
+    // _CUR so a bad rate is gone after a power cycle instead of bricking the link
+    serial.print(F("AT+UART_CUR="));
+    serial.print(baud);
+    serial.println(flowControl ? F(",8,1,0,3") : F(",8,1,0,0"));
+    serial.flush();
+
+    // The reply still comes at the old rate, then the ESP8266 switches
+    if (!waitOk()) return false;
+    // Let the OK finish before changing our rate
+    delay(5);
+    serial.begin(baud);
+    return true;
+}
+
+// Reads lines into the parser's buffer until OK, ERROR or WIFI_AT_TIMEOUT
+bool WifiServer::waitOk()
+{
+    unsigned long start = millis();
+    bool ok = false;
+
+    lineLen = 0;
+    while (millis() - start < WIFI_AT_TIMEOUT)
+    {
+        if (serial.available() <= 0) continue;
+        char c = serial.read();
+        if (c != '\n') {
+            if (c != '\r' && lineLen < WIFI_LINE_SIZE - 1) line[lineLen++] = c;
+            continue;
+        }
+
+        line[lineLen] = '\0';
+        lineLen = 0;
+        if (!strcmp_P(line, PSTR("OK"))) {
+            ok = true;
+            break;
+        }
+        if (!strcmp_P(line, PSTR("ERROR")) || !strcmp_P(line, PSTR("FAIL"))) break;
+    }
+    lineLen = 0;
+    return ok;
+}
+
+void WifiServer::begin(const WifiRoute *routes, uint8_t numRoutes)
+{
+    this->routes = routes;
+    this->numRoutes = numRoutes;
+    // Drop whatever the setup commands left behind
+    while (serial.available() > 0) serial.read();
+    statusDue = true;
+}
+
+void WifiServer::service()
+{
+    if (!routes) return;
+
+    readSerial();
+    checkTimeouts();
+    if (atState == AT_WRITE) writeChunk();
+    if (atState == AT_IDLE) startNext();
+    // Pages go first, the status waits for a quiet moment
+    if (atState == AT_IDLE) startStatus();
+    netStatus.links = numLinks();
+}
+
+uint8_t WifiServer::numLinks()
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < WIFI_MAX_LINKS; i++)
+    {
+        if (links[i].state != LINK_FREE) n++;
+    }
+    return n;
+}
+
+void WifiServer::readSerial()
+{
+    while (serial.available() > 0)
+    {
+        char c = serial.read();
+
+        // Payload of a +IPD, goes straight to its link
+        if (ipdRemain) {
+            ipdRemain--;
+            if (ipdLink < WIFI_MAX_LINKS) handleData(links[ipdLink], c);
+            continue;
+        }
+
+        // CIPSEND prompt, comes without a line ending
+        if (c == '>' && !lineLen && atState == AT_WAIT_PROMPT) {
+            written = 0;
+            atState = AT_WRITE;
+            atStart = millis();
+            continue;
+        }
+
+        if (c == '\n') {
+            if (lineLen && line[lineLen - 1] == '\r') lineLen--;
+            line[lineLen] = '\0';
+            if (lineLen) handleLine();
+            lineLen = 0;
+            continue;
+        }
+
+        // "+IPD,<id>,<len>:" then len bytes of payload
+        if (c == ':' && lineLen > 5 && !strncmp_P(line, PSTR("+IPD,"), 5)) {
+            line[lineLen] = '\0';
+            char *end;
+            ipdLink = strtoul(line + 5, &end, 10);
+            ipdRemain = (*end == ',') ? strtoul(end + 1, NULL, 10) : 0;
+            lineLen = 0;
+            continue;
+        }
+
+        if (lineLen < WIFI_LINE_SIZE - 1) line[lineLen++] = c;
+    }
+}
+
+void WifiServer::handleLine()
+{
+    // Link events look like "<id>,CONNECT" and "<id>,CLOSED"
+    if (isdigit(line[0]) && line[1] == ',') {
+        uint8_t id = line[0] - '0';
+        if (id >= WIFI_MAX_LINKS) return;
+        WifiLink &link = links[id];
+
+        if (!strcmp_P(line + 2, PSTR("CONNECT"))) {
+            memset(&link, 0, sizeof(link));
+            link.state = LINK_REQUEST;
+            link.parse = HTTP_METHOD;
+            link.query = WIFI_REQ_NONE;
+            memset(link.headers, WIFI_REQ_NONE, sizeof(link.headers));
+            link.lastActivity = millis();
+            LOG(LOG_DEBUG, "Wifi got client id:'%d'", id);
+        } else if (!strcmp_P(line + 2, PSTR("CLOSED"))) {
+            link.state = LINK_FREE;
+            LOG(LOG_DEBUG, "Released client id: '%d'", id);
+        }
+        return;
+    }
+
+    // The SoftAP reports stations leaving, and joining once they have an address
+    if (!strncmp_P(line, PSTR("+STA_DISCONNECTED"), 17) || !strncmp_P(line, PSTR("+DIST_STA_IP"), 12)) {
+        statusDue = true;
+        return;
+    }
+
+    if (atState == AT_IDLE) return;
+
+    if (atState == AT_WAIT_CIFSR || atState == AT_WAIT_CWLIF) {
+        handleStatusLine();
+        return;
+    }
+
+    if (!strcmp_P(line, PSTR("SEND OK"))) {
+        if (atState == AT_WAIT_SEND) atState = AT_IDLE;
+    } else if (!strcmp_P(line, PSTR("OK"))) {
+        // CIPSEND also answers OK before its prompt
+        if (atState == AT_WAIT_CLOSE) {
+            links[atLink].state = LINK_FREE;
+            atState = AT_IDLE;
+        }
+    } else if (!strcmp_P(line, PSTR("ERROR")) || !strcmp_P(line, PSTR("SEND FAIL"))
+        || !strcmp_P(line, PSTR("link is not valid"))) {
+        // Either way the link is gone or about to be
+        if (atState != AT_WAIT_CLOSE) LOG(LOG_ERROR, "Wifi send failed on client id: '%d'", atLink);
+        links[atLink].state = atState == AT_WAIT_CLOSE ? LINK_FREE : LINK_CLOSING;
+        atState = AT_IDLE;
+    }
+}
+
+// A refresh is AT+CIFSR for our address, then AT+CWLIF for the stations
+void WifiServer::handleStatusLine()
+{
+    if (!strcmp_P(line, PSTR("OK"))) {
+        if (atState == AT_WAIT_CIFSR) {
+            stationCount = 0;
+            serial.println(F("AT+CWLIF"));
+            atState = AT_WAIT_CWLIF;
+            atStart = millis();
+        } else {
+            netStatus.stations = stationCount;
+            netStatus.up = true;
+            netStatus.updated = millis();
+            atState = AT_IDLE;
+        }
+    } else if (!strcmp_P(line, PSTR("ERROR"))) {
+        LOG(LOG_ERROR, "Wifi status refresh failed");
+        netStatus.up = false;
+        atState = AT_IDLE;
+    } else if (atState == AT_WAIT_CIFSR) {
+        // +CIFSR:APIP,"192.168.4.1"
+        if (!strncmp_P(line, PSTR("+CIFSR:APIP,\""), 13)) {
+            char *end = strchr(line + 13, '"');
+            if (end) *end = '\0';
+            strncpy(netStatus.ip, line + 13, sizeof(netStatus.ip) - 1);
+        }
+    } else if (isdigit(line[0])) {
+        // One "<ip>,<mac>" line per station, the command echo starts with 'A'
+        stationCount++;
+    }
+}
+
+// Called for every payload byte, a request may arrive in any number of
+// +IPD packets so all state lives in the link. The request line is kept
+// in req and split in place, header names are matched as they complete
+// and only the values of the headers in httpHeaderNames are kept.
+void WifiServer::handleData(WifiLink &link, char c)
+{
+    link.lastActivity = millis();
+    if (link.state != LINK_REQUEST) return;
+
+    switch (link.parse)
+    {
+        case HTTP_METHOD:
+            if (c == ' ' && link.len) {
+                store(link, '\0');
+                link.path = link.len;
+                link.parse = HTTP_PATH;
+            } else if (c < 'A' || c > 'Z' || link.len >= WIFI_METHOD_SIZE - 1) {
+                fail(link, 400);
+            } else {
+                store(link, c);
+            }
+            break;
+
+        case HTTP_PATH:
+        case HTTP_QUERY:
+            if (c == ' ') {
+                if (link.len == link.path) {
+                    fail(link, 400);
+                    break;
+                }
+                link.parse = HTTP_VERSION;
+                c = '\0';
+            } else if (c == '?' && link.parse == HTTP_PATH) {
+                link.parse = HTTP_QUERY;
+                link.query = link.len + 1;
+                c = '\0';
+            } else if (c == '\r' || c == '\n') {
+                fail(link, 400);
+                break;
+            }
+            if (!store(link, c)) fail(link, 414);
+            break;
+
+        case HTTP_VERSION:
+            // Whatever the version, we answer in HTTP/1.1 and close
+            if (c == '\n') {
+                link.header = link.len;
+                link.parse = HTTP_HEADER_NAME;
+            }
+            break;
+
+        case HTTP_HEADER_NAME:
+            if (c == '\r') break;
+            if (c == '\n') {
+                // Blank line, end of the headers
+                if (link.len == link.header) route(link);
+                else link.len = link.header;
+            } else if (c == ':') {
+                endHeaderName(link);
+            } else if (!store(link, c)) {
+                // Longer than anything we keep
+                link.len = link.header;
+                link.parse = HTTP_HEADER_SKIP;
+            }
+            break;
+
+        case HTTP_HEADER_VALUE:
+            if (c == '\r' || ((c == ' ' || c == '\t') && link.len == link.header)) break;
+            if (c == '\n') {
+                // A value cut short is still terminated, just truncated
+                if (!store(link, '\0')) link.req[WIFI_REQ_SIZE - 1] = '\0';
+                link.headers[link.headerId] = link.header;
+                link.header = link.len;
+                link.parse = HTTP_HEADER_NAME;
+            } else {
+                store(link, c);
+            }
+            break;
+
+        case HTTP_HEADER_SKIP:
+            if (c == '\n') link.parse = HTTP_HEADER_NAME;
+            break;
+    }
+}
+
+bool WifiServer::store(WifiLink &link, char c)
+{
+    if (link.len >= WIFI_REQ_SIZE) return false;
+    link.req[link.len++] = c;
+    return true;
+}
+
+void WifiServer::endHeaderName(WifiLink &link)
+{
+    uint8_t nameLen = link.len - link.header;
+    // Drop the name either way, a kept value takes its place
+    link.len = link.header;
+    link.parse = HTTP_HEADER_SKIP;
+
+    for (uint8_t i = 0; i < HTTP_NUM_HEADERS; i++)
+    {
+        if (!strncasecmp_P(link.req + link.header, httpHeaderNames[i], nameLen)
+            && !pgm_read_byte(&httpHeaderNames[i][nameLen])) {
+            link.headerId = i;
+            link.parse = HTTP_HEADER_VALUE;
+            return;
+        }
+    }
+}
+
+void WifiServer::route(WifiLink &link)
+{
+    WifiRoute r;
+    bool pathFound = false;
+
+    for (uint8_t i = 0; i < numRoutes; i++)
+    {
+        memcpy_P(&r, &routes[i], sizeof(r));
+        if (strcmp(r.path, httpPath(link))) continue;
+        pathFound = true;
+        if (strcmp(r.method, httpMethod(link))) continue;
+
+        if (r.maxLinks && serving(r.handler) >= r.maxLinks) {
+            fail(link, 503);
+            return;
+        }
+        link.handler = r.handler;
+        link.state = LINK_RESPONSE;
+        link.part = 0;
+        link.offset = 0;
+        return;
+    }
+    fail(link, pathFound ? 405 : 404);
+}
+
+// Links the handler is answering right now, long lived ones like /events stay in here
+uint8_t WifiServer::serving(WifiHandler handler)
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < WIFI_MAX_LINKS; i++)
+    {
+        if (links[i].state == LINK_RESPONSE && links[i].handler == handler) n++;
+    }
+    return n;
+}
+
+// Answer right away, the rest of the request is ignored since we close after
+void WifiServer::fail(WifiLink &link, uint16_t status)
+{
+    LOG(LOG_DEBUG, "Wifi request failed with %u", status);
+    link.status = status;
+    link.handler = &httpError;
+    link.state = LINK_RESPONSE;
+    link.part = 0;
+    link.offset = 0;
+}
+
+// Only writes what fits in the serial TX buffer, a big chunk goes out
+// over several passes instead of blocking until it is all sent
+void WifiServer::writeChunk()
+{
+    uint16_t n = MIN((uint16_t)serial.availableForWrite(), chunkLen - written);
+
+    if (chunkP) {
+        for (uint16_t i = 0; i < n; i++) serial.write(pgm_read_byte(chunkP + written + i));
+    } else {
+        serial.write((const uint8_t *)chunk + written, n);
+    }
+    written += n;
+
+    if (written >= chunkLen) {
+        atState = AT_WAIT_SEND;
+        atStart = millis();
+    }
+}
+
+void WifiServer::startNext()
+{
+    for (uint8_t n = 0; n < WIFI_MAX_LINKS; n++)
+    {
+        uint8_t id = (nextLink + n) % WIFI_MAX_LINKS;
+        WifiLink &link = links[id];
+
+        if (link.state == LINK_RESPONSE) {
+            int16_t len = link.pgmLen ? WIFI_RESPONSE_FLASH : link.handler(link, chunk, sizeof(chunk));
+            if (len == WIFI_RESPONSE_DONE) {
+                link.state = LINK_CLOSING;
+            } else if (len == WIFI_RESPONSE_FLASH && link.pgmLen) {
+                chunkP = link.pgm;
+                startSend(id, MIN(link.pgmLen, WIFI_FLASH_CHUNK_SIZE));
+                link.pgm += chunkLen;
+                link.pgmLen -= chunkLen;
+            } else if (len <= 0) {
+                continue;
+            } else {
+                chunkP = NULL;
+                startSend(id, MIN((uint16_t)len, sizeof(chunk)));
+            }
+        }
+
+        if (link.state == LINK_CLOSING && atState == AT_IDLE) {
+            serial.print(F("AT+CIPCLOSE="));
+            serial.println(id);
+            atState = AT_WAIT_CLOSE;
+        }
+
+        if (atState != AT_IDLE) {
+            link.lastActivity = atStart = millis();
+            atLink = id;
+            nextLink = (id + 1) % WIFI_MAX_LINKS;
+            return;
+        }
+    }
+}
+
+void WifiServer::startSend(uint8_t id, uint16_t len)
+{
+    chunkLen = len;
+    serial.print(F("AT+CIPSEND="));
+    serial.print(id);
+    serial.print(',');
+    serial.println(chunkLen);
+    atState = AT_WAIT_PROMPT;
+}
+
+// Only runs when no link has anything to send
+void WifiServer::startStatus()
+{
+    if (!statusDue && millis() - statusStart < WIFI_STATUS_INTERVAL) return;
+
+    statusDue = false;
+    statusStart = atStart = millis();
+    serial.println(F("AT+CIFSR"));
+    atState = AT_WAIT_CIFSR;
+}
+
+void WifiServer::checkTimeouts()
+{
+    unsigned long ms = millis();
+
+    if ((atState == AT_WAIT_CIFSR || atState == AT_WAIT_CWLIF) && ms - atStart > WIFI_AT_TIMEOUT) {
+        LOG(LOG_ERROR, "Wifi status refresh timed out");
+        netStatus.up = false;
+        atState = AT_IDLE;
+    } else if (atState != AT_IDLE && ms - atStart > WIFI_AT_TIMEOUT) {
+        LOG(LOG_ERROR, "Wifi AT command timed out on client id: '%d'", atLink);
+        links[atLink].state = atState == AT_WAIT_CLOSE ? LINK_FREE : LINK_CLOSING;
+        atState = AT_IDLE;
+    }
+
+    for (uint8_t id = 0; id < WIFI_MAX_LINKS; id++)
+    {
+        WifiLink &link = links[id];
+        if (link.state == LINK_REQUEST && ms - link.lastActivity > WIFI_LINK_TIMEOUT) {
+            LOG(LOG_DEBUG, "Wifi client id: '%d' timed out", id);
+            link.state = LINK_CLOSING;
+        }
+    }
+}
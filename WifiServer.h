@@ -0,0 +1,223 @@
+/*
+  WifiServer.h - Non blocking HTTP server on the ESP8266 AT firmware's
+  multiplexed links, every link is parsed and answered on its own
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef WIFI_SERVER_H
+#define WIFI_SERVER_H
+
+#include <Arduino.h>
+#include "FeederUtils.h"
+
+// The AT firmware supports link ids 0-4
+#define WIFI_MAX_LINKS 5
+// Longest status line we care about from the ESP8266
+#define WIFI_LINE_SIZE 32
+// Bytes sent per AT+CIPSEND from RAM
+#define WIFI_CHUNK_SIZE 128
+// Bytes sent per AT+CIPSEND straight from flash, one full TCP segment
+#define WIFI_FLASH_CHUNK_SIZE 1460
+// Close a link that went this many ms without finishing its request, links
+// being answered are left alone so a handler can hold one open to stream
+#define WIFI_LINK_TIMEOUT 5000
+// Give up on an AT command after this many ms
+#define WIFI_AT_TIMEOUT 2000
+// ms between background refreshes of WifiStatus, stations joining or
+// leaving refresh it right away
+#define WIFI_STATUS_INTERVAL 30000
+// Handler return value once the response is complete
+#define WIFI_RESPONSE_DONE (-1)
+// Handler return value after handing the server flash data, see wifiSendP()
+#define WIFI_RESPONSE_FLASH (-2)
+// Request line and kept header values of one link, parsed in place
+#define WIFI_REQ_SIZE 96
+#define WIFI_METHOD_SIZE 8
+#define WIFI_PATH_SIZE 24
+// Offset of a request part that was not sent
+#define WIFI_REQ_NONE 0xFF
+
+// Headers whose values are kept for the handlers, see httpHeader()
+typedef enum HttpHeader
+{
+    HTTP_ACCEPT_ENCODING,
+    HTTP_IF_NONE_MATCH,
+    HTTP_NUM_HEADERS,
+} HttpHeader;
+
+typedef enum HttpParseState
+{
+    HTTP_METHOD,
+    HTTP_PATH,
+    HTTP_QUERY,
+    HTTP_VERSION,
+    HTTP_HEADER_NAME,
+    HTTP_HEADER_VALUE,
+    HTTP_HEADER_SKIP,
+} HttpParseState;
+
+typedef enum WifiLinkState
+{
+    LINK_FREE,
+    LINK_REQUEST,
+    LINK_RESPONSE,
+    LINK_CLOSING,
+} WifiLinkState;
+
+typedef struct WifiLink WifiLink;
+
+// Fills buf with the next piece of the response and returns its length,
+// 0 if nothing is ready yet or WIFI_RESPONSE_DONE once it is complete
+typedef int16_t (*WifiHandler)(WifiLink &link, char *buf, uint16_t size);
+
+struct WifiLink
+{
+    WifiLinkState state;
+    HttpParseState parse;
+    // Method, path, query and kept header values, each '\0' terminated
+    char req[WIFI_REQ_SIZE];
+    uint8_t len;
+    uint8_t path;
+    uint8_t query;
+    // Start of the header name being read
+    uint8_t header;
+    // Kept header this value belongs to
+    uint8_t headerId;
+    uint8_t headers[HTTP_NUM_HEADERS];
+    // Error status to answer with, 0 if a route was found
+    uint16_t status;
+    WifiHandler handler;
+    // Response cursor, owned by the handler
+    uint8_t part;
+    uint16_t offset;
+    // Flash data still to send before the handler is called again
+    const char *pgm;
+    uint16_t pgmLen;
+    unsigned long lastActivity;
+};
+
+// Kept up to date by the server between requests, cheap to read anywhere
+typedef struct WifiStatus
+{
+    // The ESP8266 answered the last refresh
+    bool up;
+    // Our address on the AP, empty until the first refresh
+    char ip[16];
+    // Stations joined to the AP
+    uint8_t stations;
+    // Open TCP links, updated every service()
+    uint8_t links;
+    // millis() of the last good refresh
+    unsigned long updated;
+} WifiStatus;
+
+// Lives in flash, first exact match on method and path wins
+typedef struct WifiRoute
+{
+    char method[WIFI_METHOD_SIZE];
+    char path[WIFI_PATH_SIZE];
+    WifiHandler handler;
+    // Links this handler may answer at once, more get a 503. 0 (left out) for no limit.
+    uint8_t maxLinks;
+} WifiRoute;
+
+inline const char *httpMethod(const WifiLink &link) { return link.req; }
+inline const char *httpPath(const WifiLink &link) { return link.req + link.path; }
+// NULL if the request had no query string
+inline const char *httpQuery(const WifiLink &link)
+{
+    return link.query == WIFI_REQ_NONE ? NULL : link.req + link.query;
+}
+// NULL if the request did not send that header
+inline const char *httpHeader(const WifiLink &link, HttpHeader id)
+{
+    return link.headers[id] == WIFI_REQ_NONE ? NULL : link.req + link.headers[id];
+}
+// Return this from a handler to send len bytes of flash without copying
+// them to RAM, the handler is called again once they are all out
+inline int16_t wifiSendP(WifiLink &link, const char *data, uint16_t len)
+{
+    link.pgm = data;
+    link.pgmLen = len;
+    return WIFI_RESPONSE_FLASH;
+}
+
+class WifiServer
+{
+    // Only one AT command can be in flight, shared by all links
+    typedef enum AtState
+    {
+        AT_IDLE,
+        AT_WAIT_PROMPT,
+        AT_WRITE,
+        AT_WAIT_SEND,
+        AT_WAIT_CLOSE,
+        AT_WAIT_CIFSR,
+        AT_WAIT_CWLIF,
+    } AtState;
+
+public:
+    WifiServer(HardwareSerial &serial);
+
+    // Sends cmd, followed by arg unless it is negative, and waits for OK.
+    // Blocks for up to WIFI_AT_TIMEOUT, so only call it before begin().
+    bool command(const __FlashStringHelper *cmd, long arg = -1);
+    // Switches the ESP8266 and our end of the link to baud, optionally with
+    // RTS/CTS. Blocks like command().
+    bool setBaud(uint32_t baud, bool flowControl);
+    // Call once the ESP8266 is listening, the server owns the serial port from then on
+    void begin(const WifiRoute *routes, uint8_t numRoutes);
+    // Never blocks on the ESP8266, call every couple of ms
+    void service();
+    uint8_t numLinks();
+    const WifiStatus &status() { return netStatus; }
+
+private:
+    HardwareSerial &serial;
+    const WifiRoute *routes;
+    uint8_t numRoutes;
+    WifiLink links[WIFI_MAX_LINKS];
+
+    // ESP8266 output parser
+    char line[WIFI_LINE_SIZE];
+    uint8_t lineLen;
+    uint8_t ipdLink;
+    uint16_t ipdRemain;
+
+    // Command in flight
+    AtState atState;
+    uint8_t atLink;
+    unsigned long atStart;
+    // Link to look at first next time, so every link gets its turn
+    uint8_t nextLink;
+    char chunk[WIFI_CHUNK_SIZE];
+    // Flash data being sent instead of chunk, NULL if none
+    const char *chunkP;
+    uint16_t chunkLen;
+    // Bytes of the chunk written to the serial port so far
+    uint16_t written;
+
+    WifiStatus netStatus;
+    // A station came or went since the last refresh
+    bool statusDue;
+    unsigned long statusStart;
+    uint8_t stationCount;
+
+    bool waitOk();
+    void readSerial();
+    void handleLine();
+    void handleStatusLine();
+    void handleData(WifiLink &link, char c);
+    bool store(WifiLink &link, char c);
+    void endHeaderName(WifiLink &link);
+    void route(WifiLink &link);
+    void fail(WifiLink &link, uint16_t status);
+    uint8_t serving(WifiHandler handler);
+    void writeChunk();
+    void startNext();
+    void startSend(uint8_t id, uint16_t len);
+    void startStatus();
+    void checkTimeouts();
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include "WifiUart.h"
+// The inline HardwareSerial constructor and RX handler live here
+#include "HardwareSerial_private.h"
+#include <util/atomic.h>
+
+// Defined in the sketch, ahead of anything that begin()s it
+extern WifiUart wifiSerial;
+
+WifiUart::WifiUart(uint8_t rtsPin, uint8_t ctsPin)
+: HardwareSerial(&UBRR1H, &UBRR1L, &UCSR1A, &UCSR1B, &UCSR1C, &UDR1)
+{
+    stalled = false;
+    rtsPort = NULL;
+    this->ctsPin = NULL;
+    rtsMask = 0;
+    ctsMask = 0;
+
+    // Only the port and mask are kept so the ISR can check them in a couple of cycles
+    if (rtsPin != WIFI_UART_NO_PIN && ctsPin != WIFI_UART_NO_PIN) {
+        pinMode(rtsPin, OUTPUT);
+        digitalWrite(rtsPin, LOW);
+        pinMode(ctsPin, INPUT_PULLUP);
+        rtsPort = portOutputRegister(digitalPinToPort(rtsPin));
+        rtsMask = digitalPinToBitMask(rtsPin);
+        this->ctsPin = portInputRegister(digitalPinToPort(ctsPin));
+        ctsMask = digitalPinToBitMask(ctsPin);
+    }
+}
+
+int WifiUart::available(void)
+{
+    return rx.numElements();
+}
+
+int WifiUart::peek(void)
+{
+    uint8_t *c = rx.peek(0);
+    return c ? *c : -1;
+}
+
+int WifiUart::read(void)
+{
+    uint8_t c;
+    if (!rx.pull(c)) return -1;
+    // Room again, let the ESP8266 carry on
+    if (rtsMask && (*rtsPort & rtsMask) && available() < WIFI_UART_RTS_LOW) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            *rtsPort &= ~rtsMask;
+        }
+    }
+    return c;
+}
+
+int WifiUart::availableForWrite(void)
+{
+    resume();
+    return tx.numFree();
+}
+
+void WifiUart::flush(void)
+{
+    if (!_written) return;
+
+    // Same as HardwareSerial, wait for the ring and then the shift register
+    while (bit_is_set(*_ucsrb, UDRIE0) || stalled || bit_is_clear(*_ucsra, TXC0))
+    {
+        resume();
+        if (bit_is_clear(SREG, SREG_I) && bit_is_set(*_ucsrb, UDRIE0)
+            && bit_is_set(*_ucsra, UDRE0))
+            txIsr();
+    }
+}
+
+size_t WifiUart::write(uint8_t c)
+{
+    _written = true;
+
+    // Straight into the data register when nothing is queued, like HardwareSerial
+    if (tx.isEmpty() && bit_is_set(*_ucsra, UDRE0) && !stalled && ctsReady()) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            *_udr = c;
+            *_ucsra = ((*_ucsra) & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);
+        }
+        return 1;
+    }
+
+    while (!tx.add(c)) waitForRoom();
+    startTx();
+    return 1;
+}
+
+size_t WifiUart::write(const uint8_t *buf, size_t size)
+{
+    size_t done = 0;
+
+    _written = true;
+    while (done < size)
+    {
+        uint16_t n = tx.add(buf + done, size - done);
+        if (!n) {
+            waitForRoom();
+            continue;
+        }
+        done += n;
+        // Get it going on the first piece, not after the whole chunk is in
+        startTx();
+    }
+    return size;
+}
+
+void WifiUart::waitForRoom()
+{
+    resume();
+    if (bit_is_clear(SREG, SREG_I) && bit_is_set(*_ucsra, UDRE0)) txIsr();
+}
+
+void WifiUart::startTx()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        if (!stalled) *_ucsrb |= _BV(UDRIE0);
+    }
+}
+
+void WifiUart::txIsr()
+{
+    // The ESP8266 is full, stop here until resume() sees CTS drop again
+    if (!ctsReady()) {
+        stalled = true;
+        *_ucsrb &= ~_BV(UDRIE0);
+        return;
+    }
+
+    uint8_t c;
+    if (tx.pull(c)) {
+        *_udr = c;
+        *_ucsra = ((*_ucsra) & ((1 << U2X0) | (1 << MPCM0))) | (1 << TXC0);
+    }
+
+    if (tx.isEmpty()) *_ucsrb &= ~_BV(UDRIE0);
+}
+
+void WifiUart::rxIsr()
+{
+    // Reading UDR clears the interrupt either way, a parity error is dropped
+    if (bit_is_clear(*_ucsra, UPE0)) {
+        uint8_t c = *_udr;
+        rx.add(c);
+    } else {
+        (void)*_udr;
+    }
+    // Tell the ESP8266 to hold off before the RX ring overflows
+    if (rtsMask && rx.numElements() >= WIFI_UART_RTS_HIGH) *rtsPort |= rtsMask;
+}
+
+// No pin change interrupt for CTS, so whoever is waiting to write polls it
+void WifiUart::resume()
+{
+    if (!stalled || !ctsReady()) return;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        stalled = false;
+        if (!tx.isEmpty()) *_ucsrb |= _BV(UDRIE0);
+    }
+}
+
+ISR(USART1_RX_vect)
+{
+    wifiSerial.rxIsr();
+}
+
+ISR(USART1_UDRE_vect)
+{
+    wifiSerial.txIsr();
+}
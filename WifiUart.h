@@ -0,0 +1,67 @@
+/*
+  WifiUart.h - USART1 driver for the ESP8266 link, a HardwareSerial with
+  large interrupt driven RX and TX rings and optional RTS/CTS flow control
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef WIFI_UART_H
+#define WIFI_UART_H
+
+#include <Arduino.h>
+#include <RingBufCPP.h>
+
+// Power of two, at most 256 so the ring indexes are single bytes the ISR
+// can update atomically, one slot always stays empty
+#define WIFI_UART_TX_SIZE 256
+// Same rules, 255 bytes is ~22ms at 115200, the core's 64 would be gone in 5ms
+#define WIFI_UART_RX_SIZE 256
+// Raise RTS once the RX ring is this full, drop it again below the low mark
+#define WIFI_UART_RTS_HIGH (WIFI_UART_RX_SIZE - 32)
+#define WIFI_UART_RTS_LOW (WIFI_UART_RX_SIZE / 2)
+// Flow control pin that is not wired
+#define WIFI_UART_NO_PIN 0xFF
+
+// Replaces Serial1, which must not be used anywhere else since this owns
+// the USART1 interrupts. HardwareSerial's own 64 byte RX buffer is unused.
+class WifiUart : public HardwareSerial
+{
+public:
+    // rtsPin goes to the ESP8266 CTS (GPIO15), ctsPin to its RTS (GPIO13)
+    WifiUart(uint8_t rtsPin = WIFI_UART_NO_PIN, uint8_t ctsPin = WIFI_UART_NO_PIN);
+
+    virtual int available(void);
+    virtual int peek(void);
+    virtual int read(void);
+    virtual int availableForWrite(void);
+    virtual void flush(void);
+    virtual size_t write(uint8_t c);
+    // Whole chunks go into the ring with a memcpy()
+    virtual size_t write(const uint8_t *buf, size_t size);
+    using Print::write;
+
+    bool hasFlowControl() { return rtsMask && ctsMask; }
+
+    // Called from the USART1 interrupts only
+    void txIsr();
+    void rxIsr();
+
+private:
+    volatile uint8_t *rtsPort;
+    volatile uint8_t *ctsPin;
+    uint8_t rtsMask, ctsMask;
+    // The ESP8266 told us to hold off, the ISR stopped until it clears
+    volatile bool stalled;
+
+    // write() is the only producer and txIsr() the only consumer
+    RingBufCPP<uint8_t, WIFI_UART_TX_SIZE> tx;
+    // rxIsr() is the only producer and read() the only consumer
+    RingBufCPP<uint8_t, WIFI_UART_RX_SIZE> rx;
+
+    bool ctsReady() { return !ctsMask || !(*ctsPin & ctsMask); }
+    void resume();
+    // Waits for room, doing the ISR's job if interrupts are off
+    void waitForRoom();
+    void startTx();
+};
+
+#endif
@@ -0,0 +1,32 @@
+/*
+  HostBench.h - Times a loop on the host and prints one line per case,
+  the same columns as the on-device 'bench' command:
+    bench <name> <iterations> <total us> <ns per iteration>
+  Host numbers only compare implementations with each other, the AVR is
+  a couple of hundred times slower and weighs some operations differently.
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <chrono>
+
+// Results go here so the compiler can't drop the work
+static volatile uint32_t benchSink;
+
+template<typename Fn>
+double benchRun(const char *name, uint32_t iters, Fn fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iters; i++) fn(i);
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("bench %s %lu %lu %.1f\n", name, (unsigned long)iters, (unsigned long)(ns / 1000), ns / iters);
+    return ns / iters;
+}
+
+#endif
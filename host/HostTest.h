@@ -0,0 +1,31 @@
+/*
+  HostTest.h - The little the host tests share, a check that counts
+  failures and prints where they were
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static unsigned long testChecks = 0;
+static unsigned long testFailures = 0;
+
+// Only the first few failures are printed, one bug tends to fail thousands
+#define CHECK(cond, fmt, ...) \
+    do { \
+        testChecks++; \
+        if (!(cond) && ++testFailures <= 10) { \
+            printf("%s:%d: " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// Exit status for main()
+static int testsDone(const char *name)
+{
+    printf("%s: %lu checks, %lu failed\n", name, testChecks, testFailures);
+    return testFailures ? 1 : 0;
+}
+
+#endif
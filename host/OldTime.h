@@ -0,0 +1,82 @@
+/*
+  OldTime.h - breakTime() and makeTime() as they were before they were made
+  constant time, walking year by year and month by month. Only here as the
+  reference the host tests compare the library against.
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef OLD_TIME_H
+#define OLD_TIME_H
+
+#include "TimeLib.h"
+
+#define OLD_LEAP_YEAR(Y) (((1970+(Y))>0) && !((1970+(Y))%4) && (((1970+(Y))%100) || !((1970+(Y))%400)))
+
+static const uint8_t oldMonthDays[] = {31,28,31,30,31,30,31,31,30,31,30,31};
+
+inline void oldBreakTime(time_t timeInput, tmElements_t &tm)
+{
+    uint8_t year;
+    uint8_t month, monthLength;
+    uint32_t time;
+    unsigned long days;
+
+    time = (uint32_t)timeInput;
+    tm.Second = time % 60;
+    time /= 60;
+    tm.Minute = time % 60;
+    time /= 60;
+    tm.Hour = time % 24;
+    time /= 24;
+    tm.Wday = ((time + 4) % 7) + 1;
+
+    year = 0;
+    days = 0;
+    while ((unsigned)(days += (OLD_LEAP_YEAR(year) ? 366 : 365)) <= time) {
+        year++;
+    }
+    tm.Year = year;
+
+    days -= OLD_LEAP_YEAR(year) ? 366 : 365;
+    time -= days;
+
+    for (month = 0; month < 12; month++) {
+        if (month == 1) {
+            monthLength = OLD_LEAP_YEAR(year) ? 29 : 28;
+        } else {
+            monthLength = oldMonthDays[month];
+        }
+        if (time >= monthLength) {
+            time -= monthLength;
+        } else {
+            break;
+        }
+    }
+    tm.Month = month + 1;
+    tm.Day = time + 1;
+}
+
+inline time_t oldMakeTime(const tmElements_t &tm)
+{
+    int i;
+    uint32_t seconds;
+
+    seconds = tm.Year * (SECS_PER_DAY * 365);
+    for (i = 0; i < tm.Year; i++) {
+        if (OLD_LEAP_YEAR(i)) seconds += SECS_PER_DAY;
+    }
+    for (i = 1; i < tm.Month; i++) {
+        if (i == 2 && OLD_LEAP_YEAR(tm.Year)) {
+            seconds += SECS_PER_DAY * 29;
+        } else {
+            seconds += SECS_PER_DAY * oldMonthDays[i - 1];
+        }
+    }
+    seconds += (tm.Day - 1) * SECS_PER_DAY;
+    seconds += tm.Hour * SECS_PER_HOUR;
+    seconds += tm.Minute * SECS_PER_MIN;
+    seconds += tm.Second;
+    return (time_t)seconds;
+}
+
+#endif
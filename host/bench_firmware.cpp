@@ -0,0 +1,149 @@
+/*
+  bench_firmware.cpp - The sketch's own code on the host, with each door
+  and cooler state forced so a run times the same paths every time. The
+  on-device 'bench' can only catch whatever state the feeder is in.
+  Created by D. Aaron Wisner
+  Released into the public domain.
+
+  The clock only moves when this file moves hostMillis, so a state is
+  reached by stepping the clock and then held there for the whole loop.
+*/
+#include "HostBench.h"
+#include <LiquidCrystal.h>
+#include "FeederConfig.h"
+#include "FeedCompart.h"
+#include "ThermoCooler.h"
+#include "MenuDisplay.h"
+
+#define BENCH_ITERS 1000000UL
+// Each displayMenu() is a full redraw, fewer of them
+#define BENCH_MENU_ITERS 200000UL
+
+SoundPlayer piezo;
+Pca9685 servoExpander(SERVO_EXPANDER_ADDR);
+FeedCompart feeds[NUM_FEEDS];
+LiquidCrystal lcd(LCD_RS_PIN, LCD_EN_PIN, LCD_D4_PIN, LCD_D5_PIN, LCD_D6_PIN, LCD_D7_PIN);
+
+// What the cooler's sensor reads, a new reading every pass like getTemp()
+static double coolerReading;
+
+static bool fakeTemp(double &temp, double &sigma)
+{
+    temp = coolerReading;
+    sigma = 0.5;
+    return true;
+}
+
+static void fakePwm(uint8_t duty)
+{
+    benchSink = duty;
+}
+
+ThermoCooler cooler(&fakePwm, &fakeTemp, EEPROM_COOLER_SETTINGS_LOC);
+
+static bool expect(bool ok, const char *what)
+{
+    if (!ok) fprintf(stderr, "bench_firmware: %s\n", what);
+    return ok;
+}
+
+static void benchFeed(const char *name, FeedCompart &feed)
+{
+    benchRun(name, BENCH_ITERS, [&](uint32_t) { feed.service(); });
+}
+
+static void benchCooler(const char *name)
+{
+    // Ramp up the estimator's confidence before timing
+    for (uint16_t i = 0; i < 200; i++)
+    {
+        hostMillis += TEMP_FAST_INTERVAL;
+        cooler.service();
+    }
+    benchRun(name, BENCH_ITERS, [](uint32_t) {
+        hostMillis += TEMP_FAST_INTERVAL;
+        cooler.service();
+    });
+}
+
+int main()
+{
+    bool ok = true;
+
+    // Mon 19 Oct 2026 12:00:00
+    hostMillis = 1000;
+    setTime(1792411200UL);
+    time_t start = now();
+
+    benchRun("now", BENCH_ITERS, [](uint32_t) { benchSink = now(); });
+    benchRun("crc", BENCH_ITERS, [](uint32_t) {
+        benchSink = EEGenerateCrc(EEPROM_FEEDER_SETTING_LOC, FEED_COMPART_EE_SIZE);
+    });
+    benchRun("log", BENCH_ITERS, [](uint32_t) {
+        char buf[ERROR_BUF_SIZE];
+        uint16_t n = createDebugString(buf, sizeof(buf), __LINE__, LOG_DEBUG);
+        snprintf_P(buf + n, MAX(0, sizeof(buf) - n), PSTR("System Temp %dF (%d%%)"), 72, 50);
+        benchSink = buf[0];
+    });
+
+    FeedCompart &feed = feeds[0];
+    const FeedCompartDesc &desc = feedCompartDescs[0];
+    feed.begin();
+    feed.setWeekDay(weekday(start));
+    feed.setHour(hour(start) + 1);
+    feed.setMin(0);
+
+    // Nothing scheduled
+    feed.disable();
+    benchFeed("feedoff", feed);
+    ok &= expect(!feed.isDoorOpen(), "feedoff opened the door");
+
+    // Scheduled for later today, builds the opening time every pass
+    feed.enable();
+    benchFeed("feedarmed", feed);
+    ok &= expect(!feed.isDoorOpen(), "feedarmed opened the door");
+
+    // Half way through opening
+    feed.setHour(hour(start));
+    feed.service();
+    ok &= expect(feed.isDoorOpen(), "door did not start opening");
+    hostMillis += DOOR_SPEED / 2;
+    benchFeed("feedopening", feed);
+    ok &= expect(feed.getServo().read() != desc.openDeg, "feedopening finished opening");
+
+    // Fully open, waiting out DOOR_OPEN_TIME
+    hostMillis += DOOR_SPEED;
+    feed.service();
+    feed.service();
+    ok &= expect(feed.getServo().read() == desc.openDeg, "door did not open");
+    benchFeed("feedopen", feed);
+
+    // Half way through closing
+    hostMillis += 60000UL * DOOR_OPEN_TIME + 1;
+    feed.service();
+    hostMillis += DOOR_SPEED / 2;
+    benchFeed("feedclosing", feed);
+    ok &= expect(feed.isDoorOpen() && feed.getServo().read() != desc.closeDeg,
+        "feedclosing finished closing");
+
+    cooler.begin();
+    cooler.enable();
+    // Inside TC_PWM_DELTA_DEG of the set temp, the PWM branch
+    coolerReading = cooler.getSetTemp() + 0.5;
+    benchCooler("coolerpwm");
+    ok &= expect(cooler.getPwmPercent() > 0 && cooler.getPwmPercent() < 100, "coolerpwm not in the PWM band");
+    // Far over it, full power and learning the cooling rate
+    coolerReading = cooler.getSetTemp() + 10;
+    benchCooler("coolerfull");
+    ok &= expect(cooler.getPwmPercent() == 100, "coolerfull not at full power");
+
+    lcd.begin(16, LCD_ROWS);
+    Menu mm("KittyFeeder" VERSION, &displayMenu);
+    Menu items[] = { Menu("Feeders"), Menu("Cooler"), Menu("Clock"), Menu("Wifi"), Menu("About") };
+    for (uint8_t i = 0; i < sizeof(items) / sizeof(items[0]); i++) mm.add_menu(&items[i]);
+    benchRun("menu", BENCH_MENU_ITERS, [&](uint32_t) { displayMenu(&mm); });
+    ok &= expect(!strcmp(lcd.line(1), "2 Cooler        "), "menu drew the wrong second row");
+    ok &= expect(lcd.line(0)[1] == ARROW_CHAR, "menu arrow is not on the first row");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+/*
+  bench_ringbuf.cpp - The C RingBuf against RingBufCPP, one byte in and out
+  at a time and in 32 byte blocks like a WifiUart chunk
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#include "HostBench.h"
+#include <RingBuf.h>
+#include <RingBufCPP.h>
+
+#define BENCH_ITERS 10000000UL
+#define BENCH_BLOCK 32
+
+int main()
+{
+    static RingBuf c;
+    static RingBufCPP<uint8_t, 64> cpp;
+    uint8_t block[BENCH_BLOCK] = { 0 };
+
+    // Same usable size as the template's 63
+    if (RingBuf_init(&c, sizeof(uint8_t), 63)) {
+        printf("RingBuf_init() failed\n");
+        return 1;
+    }
+
+    double cByte = benchRun("ringbuf", BENCH_ITERS, [&](uint32_t i) {
+        uint8_t v = i;
+        c.add(&c, &v);
+        c.pull(&c, &v);
+        benchSink = v;
+    });
+    double cppByte = benchRun("ringcpp", BENCH_ITERS, [&](uint32_t i) {
+        uint8_t v = i;
+        cpp.add(v);
+        cpp.pull(v);
+        benchSink = v;
+    });
+    // The C library only moves one element per call
+    double cBulk = benchRun("ringbufbulk", BENCH_ITERS / BENCH_BLOCK, [&](uint32_t i) {
+        for (uint8_t k = 0; k < BENCH_BLOCK; k++) c.add(&c, &block[k]);
+        for (uint8_t k = 0; k < BENCH_BLOCK; k++) c.pull(&c, &block[k]);
+        benchSink = block[i % BENCH_BLOCK];
+    });
+    double cppBulk = benchRun("ringbulk", BENCH_ITERS / BENCH_BLOCK, [&](uint32_t i) {
+        cpp.add(block, BENCH_BLOCK);
+        cpp.pull(block, BENCH_BLOCK);
+        benchSink = block[i % BENCH_BLOCK];
+    });
+
+    printf("byte %.1fx faster, %u byte block %.1fx faster\n", cByte / cppByte, BENCH_BLOCK, cBulk / cppBulk);
+    // RingBuf_delete() would free the static struct too
+    free(c.buf);
+    return 0;
+}
@@ -0,0 +1,46 @@
+/*
+  bench_time.cpp - breakTime() and makeTime() against the old loops, over
+  times spread across the whole 32 bit range
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#include "HostBench.h"
+#include "TimeLib.h"
+#include "OldTime.h"
+
+#define BENCH_TIMES 4096
+#define BENCH_ITERS 4000000UL
+
+int main()
+{
+    static uint32_t times[BENCH_TIMES];
+    static tmElements_t elements[BENCH_TIMES];
+    // Fixed LCG so every run times the same values
+    uint32_t x = 12345;
+    for (uint16_t i = 0; i < BENCH_TIMES; i++)
+    {
+        x = x * 1664525UL + 1013904223UL;
+        times[i] = x;
+        breakTime(times[i], elements[i]);
+    }
+
+    double oldBreak = benchRun("oldbreaktime", BENCH_ITERS, [&](uint32_t i) {
+        tmElements_t tm;
+        oldBreakTime(times[i % BENCH_TIMES], tm);
+        benchSink = tm.Day;
+    });
+    double newBreak = benchRun("breaktime", BENCH_ITERS, [&](uint32_t i) {
+        tmElements_t tm;
+        breakTime(times[i % BENCH_TIMES], tm);
+        benchSink = tm.Day;
+    });
+    double oldMake = benchRun("oldmaketime", BENCH_ITERS, [&](uint32_t i) {
+        benchSink = oldMakeTime(elements[i % BENCH_TIMES]);
+    });
+    double newMake = benchRun("maketime", BENCH_ITERS, [&](uint32_t i) {
+        benchSink = makeTime(elements[i % BENCH_TIMES]);
+    });
+
+    printf("breaktime %.1fx faster, maketime %.1fx faster\n", oldBreak / newBreak, oldMake / newMake);
+    return 0;
+}
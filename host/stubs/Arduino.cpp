@@ -0,0 +1,16 @@
+#include <Arduino.h>
+#include "FeederUtils.h"
+
+unsigned long hostMillis = 0;
+bool hostEcho = false;
+HostSerial Serial;
+HostEEPROM EEPROM;
+volatile uint8_t hostIo8[64];
+volatile uint16_t hostIo16[32];
+
+// Defined by the sketch on the board
+char err_buf[ERROR_BUF_SIZE];
+uint16_t err_remain;
+// Where avr-libc's heap starts, for freeMemory()
+char __heap_start;
+char *__brkval;
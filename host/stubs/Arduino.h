@@ -0,0 +1,61 @@
+/*
+  Arduino.h - Just enough of the Arduino core to build the sketch's
+  modules on a Linux host, for the tests and benchmarks in host/
+  Created by D. Aaron Wisner
+  Released into the public domain.
+
+  Flash and RAM are the same thing here, so the _P functions and
+  pgm_read_*() are the plain ones. millis() only moves when a test moves
+  hostMillis, which keeps every run the same.
+*/
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+#ifdef __cplusplus
+typedef bool boolean;
+#endif
+
+#define _BV(bit) (1 << (bit))
+
+extern unsigned long hostMillis;
+
+inline unsigned long millis() { return hostMillis; }
+inline unsigned long micros() { return hostMillis * 1000; }
+inline void delay(unsigned long ms) { hostMillis += ms; }
+inline void delayMicroseconds(unsigned int) {}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+#ifdef __cplusplus
+// Serial output is thrown away unless a test turns hostEcho on
+extern bool hostEcho;
+
+class HostSerial
+{
+public:
+    void begin(unsigned long) {}
+    size_t print(const char *s) { if (hostEcho) fputs(s, stdout); return strlen(s); }
+    size_t println(const char *s) { size_t n = print(s); print("\n"); return n + 1; }
+};
+
+extern HostSerial Serial;
+#endif
+
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+
+#endif
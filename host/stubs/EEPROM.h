@@ -0,0 +1,32 @@
+/*
+  EEPROM.h - Host stand in for the EEPROM library, 4K of RAM that starts
+  out erased like a new chip
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define HOST_EEPROM_SIZE 4096
+
+class HostEEPROM
+{
+public:
+    HostEEPROM() { memset(data, 0xFF, sizeof(data)); }
+
+    uint8_t &operator[](int idx) { return data[idx]; }
+    uint8_t read(int idx) { return data[idx]; }
+    void write(int idx, uint8_t val) { data[idx] = val; }
+    void update(int idx, uint8_t val) { data[idx] = val; }
+    uint16_t length() { return HOST_EEPROM_SIZE; }
+
+private:
+    uint8_t data[HOST_EEPROM_SIZE];
+};
+
+extern HostEEPROM EEPROM;
+
+#endif
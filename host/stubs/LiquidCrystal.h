@@ -0,0 +1,73 @@
+/*
+  LiquidCrystal.h - Host stand in for the LCD, draws into a character grid
+  a test can read back. Printing works like the real thing, text runs on
+  along the row and whatever falls off the end is lost.
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_LIQUID_CRYSTAL_H
+#define HOST_LIQUID_CRYSTAL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define HOST_LCD_COLS 20
+#define HOST_LCD_ROWS 4
+
+class LiquidCrystal
+{
+public:
+    LiquidCrystal(uint8_t, uint8_t, uint8_t, uint8_t, uint8_t, uint8_t) : cols(16), rows(2) { clear(); }
+
+    void begin(uint8_t c, uint8_t r) { cols = c; rows = r; clear(); }
+    void clear()
+    {
+        memset(grid, ' ', sizeof(grid));
+        col = row = 0;
+    }
+    void setCursor(uint8_t c, uint8_t r)
+    {
+        col = c;
+        row = r;
+    }
+    void createChar(uint8_t, uint8_t *) {}
+
+    size_t write(uint8_t c)
+    {
+        if (row < rows && col < cols) grid[row][col] = c;
+        col++;
+        return 1;
+    }
+    size_t print(const char *s)
+    {
+        size_t n = 0;
+        while (*s) n += write(*s++);
+        return n;
+    }
+    size_t print(char c) { return write(c); }
+    size_t print(long v)
+    {
+        char buf[12];
+        snprintf(buf, sizeof(buf), "%ld", v);
+        return print(buf);
+    }
+    size_t print(int v) { return print((long)v); }
+    size_t print(unsigned int v) { return print((long)v); }
+    size_t print(uint8_t v) { return print((long)v); }
+
+    // Host side, row r as a '\0' terminated string
+    const char *line(uint8_t r)
+    {
+        memcpy(out, grid[r], cols);
+        out[cols] = '\0';
+        return out;
+    }
+
+private:
+    uint8_t cols, rows, col, row;
+    char grid[HOST_LCD_ROWS][HOST_LCD_COLS];
+    char out[HOST_LCD_COLS + 1];
+};
+
+#endif
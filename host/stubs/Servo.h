@@ -0,0 +1,27 @@
+/*
+  Servo.h - Host stand in for the Servo library, remembers the angle
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_SERVO_H
+#define HOST_SERVO_H
+
+#include <stdint.h>
+
+class Servo
+{
+public:
+    Servo() : pin(0), deg(90) {}
+
+    uint8_t attach(int p) { pin = p; return 0; }
+    void detach() { pin = 0; }
+    void write(int d) { deg = d < 0 ? 0 : d > 180 ? 180 : d; }
+    int read() { return deg; }
+    bool attached() { return pin; }
+
+private:
+    uint8_t pin;
+    int deg;
+};
+
+#endif
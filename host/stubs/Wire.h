@@ -0,0 +1,69 @@
+/*
+  Wire.h - Host stand in for the Wire library that records every
+  transmission instead of putting it on a bus, and can be told to fail
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Same buffer as the AVR Wire library, writes past it are dropped
+#define BUFFER_LENGTH 32
+
+typedef struct WireTransmission
+{
+    uint8_t addr;
+    std::vector<uint8_t> data;
+    // What endTransmission() returned for it
+    uint8_t status;
+} WireTransmission;
+
+class TwoWire
+{
+public:
+    void begin() {}
+    void setClock(uint32_t) {}
+
+    void beginTransmission(uint8_t addr)
+    {
+        current.addr = addr;
+        current.data.clear();
+    }
+
+    size_t write(uint8_t b)
+    {
+        if (current.data.size() >= BUFFER_LENGTH) return 0;
+        current.data.push_back(b);
+        return 1;
+    }
+
+    // 2 (address NACK) once passes run out while failures are left, 0 otherwise
+    uint8_t endTransmission()
+    {
+        if (passes) {
+            passes--;
+            current.status = 0;
+        } else {
+            current.status = failures ? (failures--, 2) : 0;
+        }
+        sent.push_back(current);
+        return current.status;
+    }
+
+    // Host side
+    std::vector<WireTransmission> sent;
+    // After passes more good transmissions, this many fail
+    uint8_t passes = 0;
+    uint8_t failures = 0;
+
+private:
+    WireTransmission current;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,89 @@
+/*
+  io.h - Host stand in for the ATmega2560 registers the sketch's headers
+  touch. Each one is a plain byte (or word) in RAM, so FastPin and friends
+  compile and their writes can be looked at, but nothing is wired up.
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+extern volatile uint8_t hostIo8[64];
+extern volatile uint16_t hostIo16[32];
+
+#define PINA hostIo8[0]
+#define DDRA hostIo8[1]
+#define PORTA hostIo8[2]
+#define PINB hostIo8[3]
+#define DDRB hostIo8[4]
+#define PORTB hostIo8[5]
+#define PINC hostIo8[6]
+#define DDRC hostIo8[7]
+#define PORTC hostIo8[8]
+#define PIND hostIo8[9]
+#define DDRD hostIo8[10]
+#define PORTD hostIo8[11]
+#define PINE hostIo8[12]
+#define DDRE hostIo8[13]
+#define PORTE hostIo8[14]
+#define PINF hostIo8[15]
+#define DDRF hostIo8[16]
+#define PORTF hostIo8[17]
+#define PING hostIo8[18]
+#define DDRG hostIo8[19]
+#define PORTG hostIo8[20]
+#define PINH hostIo8[21]
+#define DDRH hostIo8[22]
+#define PORTH hostIo8[23]
+#define PINJ hostIo8[24]
+#define DDRJ hostIo8[25]
+#define PORTJ hostIo8[26]
+#define PINK hostIo8[27]
+#define DDRK hostIo8[28]
+#define PORTK hostIo8[29]
+#define PINL hostIo8[30]
+#define DDRL hostIo8[31]
+#define PORTL hostIo8[32]
+
+#define TCCR0A hostIo8[33]
+#define TCCR1A hostIo8[34]
+#define TCCR2A hostIo8[35]
+#define TCCR3A hostIo8[36]
+#define TCCR4A hostIo8[37]
+#define TCCR5A hostIo8[38]
+#define OCR0A hostIo8[39]
+#define OCR0B hostIo8[40]
+#define OCR2A hostIo8[41]
+#define OCR2B hostIo8[42]
+
+#define OCR1A hostIo16[0]
+#define OCR1B hostIo16[1]
+#define OCR3A hostIo16[2]
+#define OCR3B hostIo16[3]
+#define OCR3C hostIo16[4]
+#define OCR4A hostIo16[5]
+#define OCR4B hostIo16[6]
+#define OCR4C hostIo16[7]
+#define OCR5A hostIo16[8]
+#define OCR5B hostIo16[9]
+#define OCR5C hostIo16[10]
+
+#define COM0A1 7
+#define COM0B1 5
+#define COM1A1 7
+#define COM1B1 5
+#define COM2A1 7
+#define COM2B1 5
+#define COM3A1 7
+#define COM3B1 5
+#define COM3C1 3
+#define COM4A1 7
+#define COM4B1 5
+#define COM4C1 3
+#define COM5A1 7
+#define COM5B1 5
+#define COM5C1 3
+
+#endif
@@ -0,0 +1,27 @@
+/*
+  pgmspace.h - Host stand in for avr-libc's flash access, flash is RAM
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_PGMSPACE_H
+#define HOST_PGMSPACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr) (*(void * const *)(addr))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strlen_P strlen
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+#endif
@@ -0,0 +1,14 @@
+/*
+  toneAC2.h - Host stand in for toneAC2, silent
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_TONEAC2_H
+#define HOST_TONEAC2_H
+
+#include <stdint.h>
+
+inline void toneAC2(uint8_t, uint8_t, unsigned int = 0, unsigned long = 0, uint8_t = false) {}
+inline void noToneAC2() {}
+
+#endif
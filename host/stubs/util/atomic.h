@@ -0,0 +1,14 @@
+/*
+  atomic.h - Host stand in for avr-libc's ATOMIC_BLOCK, there are no
+  interrupts to hold off so the block just runs once
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#ifndef HOST_ATOMIC_H
+#define HOST_ATOMIC_H
+
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON 0
+#define ATOMIC_BLOCK(type) for (int _atomicOnce = 1; _atomicOnce; _atomicOnce = 0)
+
+#endif
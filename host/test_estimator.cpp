@@ -0,0 +1,109 @@
+/*
+  test_estimator.cpp - TempEstimator's fixed point filter: predicting over
+  gaps up to the cooler's 60s cap, the outlier gate and starting over
+  after TE_MAX_REJECTS, and confidence falling while it coasts
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#include "HostTest.h"
+#include "TempEstimator.h"
+
+// What the cooler's sensor gives, a reading every 500ms at 0.5F
+#define STEP_MS 500
+#define SIGMA 0.5
+// A box cooling at full power, F per minute
+#define COOL_RATE -0.89
+
+// Runs the filter over a box at temp F moving at rate F/min for secs
+static double track(TempEstimator &est, double temp, double rate, uint16_t secs)
+{
+    for (uint32_t ms = 0; ms < secs * 1000UL; ms += STEP_MS)
+    {
+        temp += rate * STEP_MS / 60000;
+        est.predict(STEP_MS);
+        est.update(temp, SIGMA);
+    }
+    return temp;
+}
+
+int main()
+{
+    TempEstimator est;
+    CHECK(!est.isValid() && est.getConfidence() == 0, "new estimator claims a reading");
+
+    // Long gaps, the temperature should move along the rate the whole way
+    // and the rate itself stay put
+    track(est, 60, COOL_RATE, 600);
+    CHECK(fabs(est.getRate() - COOL_RATE) < 0.05, "learned %.3fF/min, want %.2f", est.getRate(), COOL_RATE);
+    double lastMove = 0;
+    for (uint16_t dtMs = 1000; dtMs <= 60000; dtMs += 1000)
+    {
+        TempEstimator gap = est;
+        gap.predict(dtMs);
+        double move = gap.getTemp() - est.getTemp();
+        double want = est.getRate() * dtMs / 60000;
+        CHECK(fabs(move - want) < 0.01, "predict(%u) moved %.3fF, want %.3f", dtMs, move, want);
+        CHECK(move < lastMove, "predict(%u) moved %.3fF, no further than %.3f", dtMs, move, lastMove);
+        CHECK(gap.getRate() == est.getRate(), "predict(%u) changed the rate", dtMs);
+        lastMove = move;
+
+        // After the gap the filter should still take readings on the same line
+        double temp = est.getTemp() + want;
+        temp = track(gap, temp, COOL_RATE, 10);
+        CHECK(gap.getRejects() == 0 && fabs(gap.getTemp() - temp) < 0.3,
+            "after predict(%u) at %.2fF with %u rejects, want %.2f", dtMs, gap.getTemp(), gap.getRejects(), temp);
+    }
+
+    // A flat box should stay flat, predict() used to floor its way down
+    TempEstimator flat;
+    track(flat, 40, 0, 3600);
+    CHECK(fabs(flat.getTemp() - 40) < 0.05, "flat 40F tracked as %.3f", flat.getTemp());
+
+    // One glitch is dropped and forgotten by the next good reading
+    TempEstimator gate = flat;
+    double before = gate.getTemp();
+    gate.predict(STEP_MS);
+    CHECK(!gate.update(60, SIGMA), "20F glitch was accepted");
+    CHECK(gate.getRejects() == 1 && fabs(gate.getTemp() - before) < 0.01,
+        "glitch left %u rejects and %.2fF", gate.getRejects(), gate.getTemp());
+    gate.predict(STEP_MS);
+    CHECK(gate.update(40, SIGMA) && gate.getRejects() == 0, "good reading after a glitch not taken");
+
+    // A real jump is rejected TE_MAX_REJECTS times, then it starts over there
+    for (uint8_t i = 1; i <= TE_MAX_REJECTS; i++)
+    {
+        gate.predict(STEP_MS);
+        CHECK(!gate.update(60, SIGMA), "jump reading %u accepted", i);
+        if (i < TE_MAX_REJECTS) {
+            CHECK(gate.getRejects() == i && gate.getTemp() < 41, "jump reading %u: %u rejects at %.2fF",
+                i, gate.getRejects(), gate.getTemp());
+        }
+    }
+    CHECK(gate.getRejects() == 0 && gate.getTemp() == 60 && gate.getRate() == 0,
+        "after %d rejects: %u rejects at %.2fF %.2fF/min, want a reset to 60F",
+        TE_MAX_REJECTS, gate.getRejects(), gate.getTemp(), gate.getRate());
+    gate.predict(STEP_MS);
+    CHECK(gate.update(60, SIGMA), "reading at the new level rejected after the reset");
+
+    // Coasting without readings, confidence only ever falls, and the
+    // variance cap keeps it from wrapping back up
+    TempEstimator coast = flat;
+    uint8_t conf = coast.getConfidence();
+    CHECK(conf > 80, "tracking confidence only %u", conf);
+    bool dropped = false;
+    for (uint16_t i = 0; i < 2000; i++)
+    {
+        coast.predict(60000);
+        uint8_t c = coast.getConfidence();
+        CHECK(c <= conf, "confidence rose from %u to %u coasting", conf, c);
+        if (c < 20) dropped = true;
+        conf = c;
+    }
+    CHECK(dropped && conf == 100 * TE_CONF_VAR / (TE_CONF_VAR + TE_MAX_VAR_TEMP),
+        "coasting confidence ended at %u", conf);
+    // And comes back once readings do
+    track(coast, coast.getTemp(), 0, 60);
+    CHECK(coast.getConfidence() > 80, "confidence only %u after readings came back", coast.getConfidence());
+
+    return testsDone("estimator");
+}
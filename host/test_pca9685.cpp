@@ -0,0 +1,154 @@
+/*
+  test_pca9685.cpp - Pca9685 against a simulated Wire bus and chip: which
+  channels go out in which burst, and what the registers end up holding
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#include "HostTest.h"
+#include "Pca9685.h"
+
+#define ADDR 0x40
+#define LED0_ON_L 0x06
+#define FULL_OFF 0x10
+
+// 121 from begin(), 122 * 40ns per tick
+#define TICK_NS 4880
+
+// The chip's registers, every transmission that was acked written in
+// with auto-increment
+static uint8_t regs[256];
+
+static void applySent()
+{
+    for (size_t i = 0; i < Wire.sent.size(); i++)
+    {
+        const WireTransmission &t = Wire.sent[i];
+        if (t.addr != ADDR || t.status || t.data.empty()) continue;
+        uint8_t reg = t.data[0];
+        for (size_t b = 1; b < t.data.size(); b++) regs[reg++] = t.data[b];
+    }
+}
+
+// First and last channel of burst i
+static void burstRange(size_t i, uint8_t &first, uint8_t &last)
+{
+    const WireTransmission &t = Wire.sent[i];
+    first = (t.data[0] - LED0_ON_L) / 4;
+    last = first + (t.data.size() - 1) / 4 - 1;
+}
+
+static uint16_t offReg(uint8_t ch) { return regs[LED0_ON_L + 4 * ch + 2] | (regs[LED0_ON_L + 4 * ch + 3] << 8); }
+static uint16_t onReg(uint8_t ch) { return regs[LED0_ON_L + 4 * ch] | (regs[LED0_ON_L + 4 * ch + 1] << 8); }
+
+// What the chip should be putting out for a pulse of us on ch
+static void checkChannel(uint8_t ch, uint16_t us, int line)
+{
+    uint16_t ticks = (uint32_t)us * 1000 / TICK_NS;
+    uint16_t on = (ch & 3) * 1024;
+    uint16_t off = (on + ticks) & 0x0FFF;
+    if (!ticks) off |= FULL_OFF << 8;
+    CHECK(onReg(ch) == on && offReg(ch) == off, "line %d: channel %u on %u off 0x%04x, want %u 0x%04x",
+        line, ch, onReg(ch), offReg(ch), on, off);
+}
+
+static void startSent()
+{
+    applySent();
+    Wire.sent.clear();
+}
+
+int main()
+{
+    Pca9685 pca(ADDR);
+    uint16_t pulses[PCA9685_CHANNELS] = { 0 };
+
+    CHECK(pca.begin(), "begin() failed");
+    // MODE1, PRESCALE, MODE2, MODE1, MODE1 restart, then every channel
+    CHECK(Wire.sent.size() > 5, "begin() sent %u transmissions", (unsigned)Wire.sent.size());
+    CHECK(Wire.sent[1].data.size() == 2 && Wire.sent[1].data[0] == 0xFE && Wire.sent[1].data[1] == 121,
+        "prescale not written as 121");
+    Wire.sent.erase(Wire.sent.begin(), Wire.sent.begin() + 5);
+
+    // All 16 start off, more than one Wire buffer so it splits
+    CHECK(Wire.sent.size() == 3, "16 channels took %u bursts, want 3", (unsigned)Wire.sent.size());
+    for (size_t i = 0; i < Wire.sent.size(); i++)
+    {
+        // Wire drops what doesn't fit, which would cut the last channel short
+        CHECK((Wire.sent[i].data.size() - 1) % 4 == 0, "burst %u is %u bytes, a channel was cut short",
+            (unsigned)i, (unsigned)Wire.sent[i].data.size());
+    }
+    startSent();
+    for (uint8_t ch = 0; ch < PCA9685_CHANNELS; ch++) checkChannel(ch, 0, __LINE__);
+
+    // Nothing changed, nothing sent
+    CHECK(pca.flush() && Wire.sent.empty(), "clean flush() sent %u", (unsigned)Wire.sent.size());
+    pca.setPulse(4, 0);
+    CHECK(pca.flush() && Wire.sent.empty(), "same pulse again was sent");
+
+    // Clean channels between two dirty ones ride along in one burst
+    pca.setPulse(1, pulses[1] = 1500);
+    pca.setPulse(3, pulses[3] = 1000);
+    CHECK(pca.flush(), "flush() failed");
+    CHECK(Wire.sent.size() == 1, "1 and 3 took %u bursts, want 1", (unsigned)Wire.sent.size());
+    uint8_t first, last;
+    burstRange(0, first, last);
+    CHECK(first == 1 && last == 3, "burst covered %u-%u, want 1-3", first, last);
+    startSent();
+    for (uint8_t ch = 0; ch < PCA9685_CHANNELS; ch++) checkChannel(ch, pulses[ch], __LINE__);
+
+    // Too far apart for one buffer: 0-6 fill it (7 channels in 29 bytes), 7-9 are clean so the next starts at 10
+    pca.setPulse(0, pulses[0] = 2400);
+    pca.setPulse(10, pulses[10] = 544);
+    CHECK(pca.flush(), "flush() failed");
+    CHECK(Wire.sent.size() == 2, "0 and 10 took %u bursts, want 2", (unsigned)Wire.sent.size());
+    burstRange(0, first, last);
+    CHECK(first == 0 && last == 6, "first burst covered %u-%u", first, last);
+    burstRange(1, first, last);
+    CHECK(first == 10 && last == 10, "second burst covered %u-%u, want 10-10", first, last);
+    startSent();
+    for (uint8_t ch = 0; ch < PCA9685_CHANNELS; ch++) checkChannel(ch, pulses[ch], __LINE__);
+
+    // Back to 0 sets FULL_OFF, a pulse clears it again
+    pca.setPulse(3, pulses[3] = 0);
+    CHECK(pca.flush(), "flush() failed");
+    startSent();
+    CHECK(regs[LED0_ON_L + 4 * 3 + 3] & FULL_OFF, "channel 3 at 0 without FULL_OFF");
+    pca.setPulse(3, pulses[3] = 1200);
+    CHECK(pca.flush(), "flush() failed");
+    startSent();
+    CHECK(!(regs[LED0_ON_L + 4 * 3 + 3] & FULL_OFF), "channel 3 kept FULL_OFF at 1200us");
+    // setAngle() maps like Servo.write()
+    pca.setAngle(5, 90);
+    pulses[5] = map(90, 0, 180, PCA9685_MIN_PULSE, PCA9685_MAX_PULSE);
+    CHECK(pca.flush(), "flush() failed");
+    startSent();
+    for (uint8_t ch = 0; ch < PCA9685_CHANNELS; ch++) checkChannel(ch, pulses[ch], __LINE__);
+
+    // A failed burst stays dirty and goes out with the next flush()
+    pca.setPulse(2, pulses[2] = 1700);
+    Wire.failures = 1;
+    CHECK(!pca.flush(), "flush() hid a bus error");
+    startSent();
+    checkChannel(2, 0, __LINE__);
+    CHECK(pca.flush(), "retry failed");
+    CHECK(Wire.sent.size() == 1, "retry took %u bursts", (unsigned)Wire.sent.size());
+    startSent();
+    for (uint8_t ch = 0; ch < PCA9685_CHANNELS; ch++) checkChannel(ch, pulses[ch], __LINE__);
+
+    // First burst makes it, the second fails: only the second is sent again
+    pca.setPulse(6, pulses[6] = 1100);
+    pca.setPulse(15, pulses[15] = 1900);
+    Wire.passes = 1;
+    Wire.failures = 1;
+    CHECK(!pca.flush(), "flush() hid a bus error");
+    CHECK(Wire.sent.size() == 2, "sent %u bursts before failing, want 2", (unsigned)Wire.sent.size());
+    startSent();
+    CHECK(pca.flush(), "retry failed");
+    CHECK(Wire.sent.size() == 1, "retry took %u bursts, want 1", (unsigned)Wire.sent.size());
+    burstRange(0, first, last);
+    CHECK(first == 15 && last == 15, "retry covered %u-%u, want only 15", first, last);
+    startSent();
+    for (uint8_t ch = 0; ch < PCA9685_CHANNELS; ch++) checkChannel(ch, pulses[ch], __LINE__);
+
+    return testsDone("pca9685");
+}
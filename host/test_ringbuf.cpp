@@ -0,0 +1,165 @@
+/*
+  test_ringbuf.cpp - RingBufCPP against std::deque over random sequences
+  of every call, then one producer and one consumer thread at once
+  Created by D. Aaron Wisner
+  Released into the public domain.
+*/
+#include "HostTest.h"
+#include <RingBufCPP.h>
+#include <deque>
+#include <thread>
+#include <random>
+
+#define RANDOM_OPS 200000
+#define THREAD_ITEMS 2000000UL
+
+template<uint16_t N>
+void checkAgainstDeque(uint32_t seed)
+{
+    RingBufCPP<uint16_t, N> rb;
+    std::deque<uint16_t> ref;
+    std::mt19937 rng(seed);
+    uint16_t next = 0;
+    uint16_t tmp[N + 4];
+
+    for (uint32_t i = 0; i < RANDOM_OPS; i++)
+    {
+        switch (rng() % 7)
+        {
+            case 0: {
+                bool ok = rb.add(next);
+                CHECK(ok == (ref.size() < N - 1), "N=%u add() gave %d with %u in", N, ok, (unsigned)ref.size());
+                if (ok) ref.push_back(next);
+                next++;
+                break;
+            }
+            case 1: {
+                uint16_t v;
+                bool ok = rb.pull(v);
+                CHECK(ok == !ref.empty(), "N=%u pull() gave %d with %u in", N, ok, (unsigned)ref.size());
+                if (ok) {
+                    CHECK(v == ref.front(), "N=%u pulled %u, want %u", N, v, ref.front());
+                    ref.pop_front();
+                }
+                break;
+            }
+            // Blocks up to a few more than fit, so both the wrap and the clamp get hit
+            case 2: {
+                uint16_t n = rng() % (N + 3);
+                for (uint16_t k = 0; k < n; k++) tmp[k] = next + k;
+                uint16_t added = rb.add(tmp, n);
+                uint16_t want = std::min<size_t>(n, N - 1 - ref.size());
+                CHECK(added == want, "N=%u add(%u) took %u, want %u", N, n, added, want);
+                for (uint16_t k = 0; k < added; k++) ref.push_back(tmp[k]);
+                next += n;
+                break;
+            }
+            case 3: {
+                uint16_t n = rng() % (N + 3);
+                uint16_t pulled = rb.pull(tmp, n);
+                uint16_t want = std::min<size_t>(n, ref.size());
+                CHECK(pulled == want, "N=%u pull(%u) gave %u, want %u", N, n, pulled, want);
+                for (uint16_t k = 0; k < pulled; k++)
+                {
+                    CHECK(tmp[k] == ref.front(), "N=%u block pulled %u, want %u", N, tmp[k], ref.front());
+                    ref.pop_front();
+                }
+                break;
+            }
+            case 4: {
+                uint16_t n = rng() % N;
+                uint16_t *p = rb.peek(n);
+                CHECK((p != NULL) == (n < ref.size()), "N=%u peek(%u) with %u in", N, n, (unsigned)ref.size());
+                if (p) CHECK(*p == ref[n], "N=%u peek(%u) gave %u, want %u", N, n, *p, ref[n]);
+                break;
+            }
+            case 5:
+                // Rare, or the buffer would hardly ever fill
+                if (rng() % 64 == 0) {
+                    rb.clear();
+                    ref.clear();
+                }
+                break;
+            default:
+                break;
+        }
+
+        CHECK(rb.numElements() == ref.size(), "N=%u numElements() %u, want %u", N, rb.numElements(), (unsigned)ref.size());
+        CHECK(rb.numFree() == N - 1 - ref.size(), "N=%u numFree() %u with %u in", N, rb.numFree(), (unsigned)ref.size());
+        CHECK(rb.isEmpty() == ref.empty(), "N=%u isEmpty() wrong with %u in", N, (unsigned)ref.size());
+        CHECK(rb.isFull() == (ref.size() == N - 1), "N=%u isFull() wrong with %u in", N, (unsigned)ref.size());
+    }
+}
+
+// Elements bigger than a byte still copy whole
+typedef struct Sample
+{
+    uint32_t seq;
+    uint8_t pad[5];
+} Sample;
+
+static void checkStruct()
+{
+    RingBufCPP<Sample, 8> rb;
+    Sample in[10], out[10];
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        in[i].seq = i;
+        memset(in[i].pad, i, sizeof(in[i].pad));
+    }
+    // Offset by 5 so the block wraps
+    for (uint8_t i = 0; i < 5; i++) rb.add(in[i]), rb.pull(out[i]);
+    CHECK(rb.add(in, 10) == 7, "8 slots took more than 7");
+    CHECK(rb.pull(out, 10) == 7, "pulled other than 7");
+    for (uint8_t i = 0; i < 7; i++)
+    {
+        CHECK(!memcmp(&in[i], &out[i], sizeof(Sample)), "struct %u came out different", i);
+    }
+}
+
+// The ISR and loop() case with real concurrency, a byte and a block side
+static void checkThreads()
+{
+    static RingBufCPP<uint8_t, 64> rb;
+    unsigned long errors = 0;
+
+    std::thread producer([] {
+        uint8_t chunk[7];
+        for (unsigned long i = 0; i < THREAD_ITEMS; )
+        {
+            uint8_t n = std::min<unsigned long>(sizeof(chunk), THREAD_ITEMS - i);
+            for (uint8_t k = 0; k < n; k++) chunk[k] = (uint8_t)(i + k);
+            uint16_t added = rb.add(chunk, n);
+            i += added;
+            if (!added) std::this_thread::yield();
+        }
+    });
+
+    for (unsigned long i = 0; i < THREAD_ITEMS; )
+    {
+        uint8_t v;
+        if (!rb.pull(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (v != (uint8_t)i) errors++;
+        i++;
+    }
+    producer.join();
+
+    CHECK(!errors, "%lu bytes came out of order or torn", errors);
+    CHECK(rb.isEmpty(), "%u left after the last one", rb.numElements());
+}
+
+int main()
+{
+    checkAgainstDeque<2>(1);
+    checkAgainstDeque<4>(2);
+    checkAgainstDeque<16>(3);
+    checkAgainstDeque<64>(4);
+    checkAgainstDeque<256>(5);
+    checkStruct();
+    checkThreads();
+    return testsDone("ringbuf");
+}
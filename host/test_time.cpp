@@ -0,0 +1,81 @@
+/*
+  test_time.cpp - Checks the constant time breakTime() and makeTime()
+  against the old loops over the whole 32 bit time_t range
+  Created by D. Aaron Wisner
+  Released into the public domain.
+
+  Every one of the 2^32 seconds would take the old loops over half an
+  hour here, so this checks the same thing in two sweeps. Both versions
+  split t into days = t / SECS_PER_DAY and secs = t % SECS_PER_DAY
+  first. The date and weekday come only from days, and the hour, minute
+  and second only from secs. makeTime() is the same split run backwards,
+  days * SECS_PER_DAY + secs. So if every day breaks the same, and
+  every second of a day does, then every t in between does too:
+    - every day up to 7 Feb 2106, at its first, last and a few seconds between
+    - every second of the day, on a few days with their own edge cases
+*/
+#include "HostTest.h"
+#include "TimeLib.h"
+#include "OldTime.h"
+
+// Start, end and a couple of points inside every day
+static const uint32_t secsOfDay[] = { 0, 1, 43199, 45296, 86399 };
+// 1 Jan 1970, 29 Feb 2000, 28 Feb 2100 (not a leap year) and the last,
+// partial day before 2^32 seconds
+static const uint32_t fullDays[] = { 0, 11016, 47540, 0xFFFFFFFFUL / SECS_PER_DAY };
+
+static bool sameElements(const tmElements_t &a, const tmElements_t &b)
+{
+    return a.Second == b.Second && a.Minute == b.Minute && a.Hour == b.Hour
+        && a.Wday == b.Wday && a.Day == b.Day && a.Month == b.Month && a.Year == b.Year;
+}
+
+static void checkTime(uint32_t t)
+{
+    tmElements_t got, want;
+
+    breakTime(t, got);
+    oldBreakTime(t, want);
+    CHECK(sameElements(got, want), "breakTime(%lu) gave %u-%u-%u %u:%u:%u, want %u-%u-%u %u:%u:%u",
+        (unsigned long)t, got.Year, got.Month, got.Day, got.Hour, got.Minute, got.Second,
+        want.Year, want.Month, want.Day, want.Hour, want.Minute, want.Second);
+    CHECK((uint32_t)makeTime(want) == (uint32_t)oldMakeTime(want), "makeTime(%u-%u-%u) gave %lu, want %lu",
+        want.Year, want.Month, want.Day, (unsigned long)makeTime(want), (unsigned long)t);
+    CHECK((uint32_t)makeTime(got) == t, "makeTime(breakTime(%lu)) gave %lu",
+        (unsigned long)t, (unsigned long)makeTime(got));
+}
+
+int main()
+{
+    // The last day before 2^32 seconds, 7 Feb 2106, only partly fits
+    const uint32_t lastDay = 0xFFFFFFFFUL / SECS_PER_DAY;
+    const uint32_t lastSec = 0xFFFFFFFFUL - lastDay * SECS_PER_DAY;
+
+    for (uint32_t day = 0; day <= lastDay; day++)
+    {
+        for (uint8_t i = 0; i < sizeof(secsOfDay) / sizeof(secsOfDay[0]); i++)
+        {
+            uint32_t secs = day == lastDay && secsOfDay[i] > lastSec ? lastSec : secsOfDay[i];
+            checkTime(day * SECS_PER_DAY + secs);
+        }
+    }
+
+    for (uint8_t i = 0; i < sizeof(fullDays) / sizeof(fullDays[0]); i++)
+    {
+        uint32_t end = fullDays[i] == lastDay ? lastSec : SECS_PER_DAY - 1;
+        for (uint32_t secs = 0; secs <= end; secs++) checkTime(fullDays[i] * SECS_PER_DAY + secs);
+    }
+
+    // The last second there is
+    tmElements_t tm;
+    breakTime(0xFFFFFFFFUL, tm);
+    CHECK(tm.Year == 136 && tm.Month == 2 && tm.Day == 7 && tm.Hour == 6 && tm.Minute == 28 && tm.Second == 15,
+        "breakTime(2^32 - 1) gave %u-%u-%u %u:%u:%u", tm.Year, tm.Month, tm.Day, tm.Hour, tm.Minute, tm.Second);
+    // 2100 is not a leap year, 2000 is
+    breakTime(4107542400UL, tm);
+    CHECK(tm.Month == 3 && tm.Day == 1, "1 Mar 2100 broke into %u-%u", tm.Month, tm.Day);
+    breakTime(951782400UL, tm);
+    CHECK(tm.Month == 2 && tm.Day == 29, "29 Feb 2000 broke into %u-%u", tm.Month, tm.Day);
+
+    return testsDone("time");
+}
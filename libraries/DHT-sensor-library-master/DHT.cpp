@@ -14,6 +14,7 @@ DHT::DHT(uint8_t pin, uint8_t type, uint8_t count) {
   #ifdef __AVR
     _bit = digitalPinToBitMask(pin);
     _port = digitalPinToPort(pin);
+    _pinReg = portInputRegister(_port);
   #endif
   _maxcycles = microsecondsToClockCycles(1000);  // 1 millisecond timeout for
                                                  // reading pulses from DHT sensor.
@@ -240,7 +241,7 @@ uint32_t DHT::expectPulse(bool level) {
   // for catching pulses that are 10's of microseconds in length:
   #ifdef __AVR
     uint8_t portState = level ? _bit : 0;
-    while ((*portInputRegister(_port) & _bit) == portState) {
+    while ((*_pinReg & _bit) == portState) {
       if (count++ >= _maxcycles) {
         return 0; // Exceeded timeout, fail.
       }
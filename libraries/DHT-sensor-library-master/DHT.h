@@ -53,6 +53,8 @@ class DHT {
     // Use direct GPIO access on an 8-bit AVR so keep track of the port and bitmask
     // for the digital pin connected to the DHT.  Other platforms will use digitalRead.
     uint8_t _bit, _port;
+    // Looked up once, portInputRegister() is a flash read the loop can't hoist
+    volatile uint8_t *_pinReg;
   #endif
   uint32_t _lastreadtime, _maxcycles;
   bool _lastresult;
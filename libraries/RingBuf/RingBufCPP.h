@@ -0,0 +1,131 @@
+/*
+  RingBufCPP.h - Header only, allocation free version of RingBuf for one
+  producer and one consumer, like an ISR and void loop()
+  Created by D. Aaron Wisner (daw268@cornell.edu)
+  Released into the public domain.
+*/
+#ifndef RingBufCPP_h
+#define RingBufCPP_h
+
+#include <string.h>
+#include <stdint.h>
+
+// Keeps the compiler from moving buffer accesses past an index update
+#define RB_BARRIER() __asm__ __volatile__ ("" ::: "memory")
+
+// Holds up to N - 1 Type's in static storage, N is a power of two no
+// bigger than 256 so the indexes are single bytes.
+//
+// Lock free as long as only one side ever adds and only one side ever
+// pulls: the producer is the only one writing head and the consumer the
+// only one writing tail, and a one byte write can't be torn. With more
+// than one of either, wrap the calls in ATOMIC_BLOCK yourself.
+//
+// This is not a drop in replacement, RingBuf.h and RingBufC are kept as
+// they are for code that needs a size picked at runtime. add(), pull(),
+// peek(), isFull(), isEmpty() and numElements() are named like RingBufC's
+// but take and return typed values: add() returns bool rather than the
+// index and pull() fills a Type& rather than returning a pointer.
+template <typename Type, uint16_t N>
+class RingBufCPP
+{
+    static_assert(N >= 2 && N <= 256 && !(N & (N - 1)), "N must be a power of two from 2 to 256");
+
+public:
+    RingBufCPP() : head(0), tail(0) {}
+
+    // Producer side
+    bool add(const Type &obj)
+    {
+        uint8_t h = head;
+        uint8_t next = (h + 1) & MASK;
+        if (next == tail) return false;
+
+        buf[h] = obj;
+        RB_BARRIER();
+        head = next;
+        return true;
+    }
+
+    // Copies in as many as fit, in at most two memcpy()s, returns how many
+    uint16_t add(const Type *objs, uint16_t num)
+    {
+        uint8_t h = head;
+        uint16_t n = numFree(h, tail);
+        if (num < n) n = num;
+
+        uint16_t first = N - h;
+        if (first > n) first = n;
+        memcpy(&buf[h], objs, first * sizeof(Type));
+        memcpy(&buf[0], objs + first, (n - first) * sizeof(Type));
+        RB_BARRIER();
+        head = (h + n) & MASK;
+        return n;
+    }
+
+    // Consumer side, false when empty
+    bool pull(Type *dest)
+    {
+        uint8_t t = tail;
+        if (t == head) return false;
+
+        RB_BARRIER();
+        *dest = buf[t];
+        RB_BARRIER();
+        tail = (t + 1) & MASK;
+        return true;
+    }
+
+    bool pull(Type &dest) { return pull(&dest); }
+
+    // Copies out up to num, returns how many
+    uint16_t pull(Type *dest, uint16_t num)
+    {
+        uint8_t t = tail;
+        uint16_t n = numUsed(head, t);
+        if (num < n) n = num;
+
+        RB_BARRIER();
+        uint16_t first = N - t;
+        if (first > n) first = n;
+        memcpy(dest, &buf[t], first * sizeof(Type));
+        memcpy(dest + first, &buf[0], (n - first) * sizeof(Type));
+        RB_BARRIER();
+        tail = (t + n) & MASK;
+        return n;
+    }
+
+    // Consumer side, nth oldest element or NULL, stays in the buffer
+    Type *peek(uint16_t num)
+    {
+        uint8_t t = tail;
+        if (num >= numUsed(head, t)) return NULL;
+        RB_BARRIER();
+        return &buf[(t + num) & MASK];
+    }
+
+    // Consumer side, drops everything
+    void clear() { tail = head; }
+
+    // Callable from either side, but each answer can be stale by the time it
+    // returns. The producer can only make isEmpty() false and numElements()
+    // bigger, so the consumer can trust "not empty" and the count as a
+    // minimum. The consumer can only make isFull() false and numFree()
+    // bigger, so the producer can trust "not full" and the room it sees.
+    bool isEmpty() { return head == tail; }
+    bool isFull() { return ((head + 1) & MASK) == tail; }
+    uint16_t numElements() { return numUsed(head, tail); }
+    uint16_t numFree() { return numFree(head, tail); }
+    static uint16_t capacity() { return N - 1; }
+
+private:
+    static const uint8_t MASK = N - 1;
+
+    Type buf[N];
+    volatile uint8_t head, tail;
+
+    static uint16_t numUsed(uint8_t h, uint8_t t) { return (uint8_t)(h - t) & MASK; }
+    static uint16_t numFree(uint8_t h, uint8_t t) { return (uint8_t)(t - h - 1) & MASK; }
+};
+
+#endif
@@ -46,8 +46,19 @@ void refreshCache(time_t t) {
   }
 }
 
+static timeSnapshot_t snapshot = { (time_t)-1 };  // the current time, broken down
+
+const timeSnapshot_t& timeSnapshot() {
+  time_t t = now();
+  if (t != snapshot.Time) {
+    breakTime(t, snapshot.Elements);
+    snapshot.Time = t;
+  }
+  return snapshot;
+}
+
 int hour() { // the hour now 
-  return hour(now()); 
+  return timeSnapshot().Elements.Hour; 
 }
 
 int hour(time_t t) { // the hour for the given time
@@ -56,7 +67,13 @@ int hour(time_t t) { // the hour for the given time
 }
 
 int hourFormat12() { // the hour now in 12 hour format
-  return hourFormat12(now()); 
+  uint8_t h = timeSnapshot().Elements.Hour;
+  if( h == 0 )
+    return 12; // 12 midnight
+  else if( h  > 12)
+    return h - 12 ;
+  else
+    return h ;
 }
 
 int hourFormat12(time_t t) { // the hour for the given time in 12 hour format
@@ -70,7 +87,7 @@ int hourFormat12(time_t t) { // the hour for the given time in 12 hour format
 }
 
 uint8_t isAM() { // returns true if time now is AM
-  return !isPM(now()); 
+  return !isPM(); 
 }
 
 uint8_t isAM(time_t t) { // returns true if given time is AM
@@ -78,7 +95,7 @@ uint8_t isAM(time_t t) { // returns true if given time is AM
 }
 
 uint8_t isPM() { // returns true if PM
-  return isPM(now()); 
+  return (hour() >= 12); 
 }
 
 uint8_t isPM(time_t t) { // returns true if PM
@@ -86,7 +103,7 @@ uint8_t isPM(time_t t) { // returns true if PM
 }
 
 int minute() {
-  return minute(now()); 
+  return timeSnapshot().Elements.Minute; 
 }
 
 int minute(time_t t) { // the minute for the given time
@@ -95,7 +112,7 @@ int minute(time_t t) { // the minute for the given time
 }
 
 int second() {
-  return second(now()); 
+  return timeSnapshot().Elements.Second; 
 }
 
 int second(time_t t) {  // the second for the given time
@@ -104,7 +121,7 @@ int second(time_t t) {  // the second for the given time
 }
 
 int day(){
-  return(day(now())); 
+  return timeSnapshot().Elements.Day; 
 }
 
 int day(time_t t) { // the day for the given time (0-6)
@@ -113,7 +130,7 @@ int day(time_t t) { // the day for the given time (0-6)
 }
 
 int weekday() {   // Sunday is day 1
-  return  weekday(now()); 
+  return timeSnapshot().Elements.Wday; 
 }
 
 int weekday(time_t t) {
@@ -122,7 +139,7 @@ int weekday(time_t t) {
 }
    
 int month(){
-  return month(now()); 
+  return timeSnapshot().Elements.Month; 
 }
 
 int month(time_t t) {  // the month for the given time
@@ -131,7 +148,7 @@ int month(time_t t) {  // the month for the given time
 }
 
 int year() {  // as in Processing, the full four digit year: (2009, 2010 etc) 
-  return year(now()); 
+  return tmYearToCalendar(timeSnapshot().Elements.Year); 
 }
 
 int year(time_t t) { // the year for the given time
@@ -143,93 +160,57 @@ int year(time_t t) { // the year for the given time
 /* functions to convert to and from system time */
 /* These are for interfacing with time serivces and are not normally needed in a sketch */
 
-// leap year calulator expects year argument as years offset from 1970
-#define LEAP_YEAR(Y)     ( ((1970+Y)>0) && !((1970+Y)%4) && ( ((1970+Y)%100) || !((1970+Y)%400) ) )
+// Both conversions count days from 1 Mar 1968, so every 4 year cycle ends on
+// its leap day and needs no leap year tests. 2100 is the only century the
+// 32 bit time_t reaches and it is not a leap year, so its Feb 29 is skipped.
+#define DAYS_1968_MAR_TO_1970 671UL  // 1 Mar 1968 -> 1 Jan 1970
+#define DAYS_PER_CYCLE 1461UL         // 4 years, ending on a leap day
+#define DAYS_1968_MAR_TO_2100_FEB29 48212UL
 
-static  const uint8_t monthDays[]={31,28,31,30,31,30,31,31,30,31,30,31}; // API starts months from 1, this array starts from 0
- 
 void breakTime(time_t timeInput, tmElements_t &tm){
 // break the given time_t into time components
 // this is a more compact version of the C library localtime function
 // note that year is offset from 1970 !!!
 
-  uint8_t year;
-  uint8_t month, monthLength;
-  uint32_t time;
-  unsigned long days;
-
-  time = (uint32_t)timeInput;
-  tm.Second = time % 60;
-  time /= 60; // now it is minutes
-  tm.Minute = time % 60;
-  time /= 60; // now it is hours
-  tm.Hour = time % 24;
-  time /= 24; // now it is days
-  tm.Wday = ((time + 4) % 7) + 1;  // Sunday is day 1 
-  
-  year = 0;  
-  days = 0;
-  while((unsigned)(days += (LEAP_YEAR(year) ? 366 : 365)) <= time) {
-    year++;
-  }
-  tm.Year = year; // year is offset from 1970 
-  
-  days -= LEAP_YEAR(year) ? 366 : 365;
-  time  -= days; // now it is days in this year, starting at 0
-  
-  days=0;
-  month=0;
-  monthLength=0;
-  for (month=0; month<12; month++) {
-    if (month==1) { // february
-      if (LEAP_YEAR(year)) {
-        monthLength=29;
-      } else {
-        monthLength=28;
-      }
-    } else {
-      monthLength = monthDays[month];
-    }
-    
-    if (time >= monthLength) {
-      time -= monthLength;
-    } else {
-        break;
-    }
-  }
-  tm.Month = month + 1;  // jan is month 1  
-  tm.Day = time + 1;     // day of month
+  uint32_t time = (uint32_t)timeInput;
+  uint32_t days = time / SECS_PER_DAY;
+  uint32_t secs = time - days * SECS_PER_DAY; // seconds today
+  uint8_t hour = secs / SECS_PER_HOUR;
+  uint16_t rem = secs - hour * SECS_PER_HOUR;  // under an hour, 16 bit from here
+  tm.Second = rem % 60;
+  tm.Minute = rem / 60;
+  tm.Hour = hour;
+  tm.Wday = ((days + 4) % 7) + 1;  // Sunday is day 1 
+
+  days += DAYS_1968_MAR_TO_1970;
+  if (days >= DAYS_1968_MAR_TO_2100_FEB29) days++;
+
+  uint8_t cycle = days / DAYS_PER_CYCLE;
+  uint16_t doc = days - cycle * DAYS_PER_CYCLE;  // day of the cycle
+  uint8_t yoc = doc / 365;                       // year of the cycle
+  if (yoc > 3) yoc = 3;                          // its leap day
+  uint16_t doy = doc - yoc * 365;                // day of the year from 1 Mar
+  uint8_t mp = (5 * doy + 2) / 153;              // month from Mar = 0
+  tm.Day = doy - (153 * mp + 2) / 5 + 1;
+  tm.Month = mp < 10 ? mp + 3 : mp - 9;          // jan is month 1
+  tm.Year = cycle * 4 + yoc - 2 + (tm.Month <= 2); // year is offset from 1970
 }
 
 time_t makeTime(tmElements_t &tm){   
 // assemble time elements into time_t 
 // note year argument is offset from 1970 (see macros in time.h to convert to other formats)
 // previous version used full four digit year (or digits since 2000),i.e. 2009 was 2009 or 9
-  
-  int i;
-  uint32_t seconds;
-
-  // seconds from 1970 till 1 jan 00:00:00 of the given year
-  seconds= tm.Year*(SECS_PER_DAY * 365);
-  for (i = 0; i < tm.Year; i++) {
-    if (LEAP_YEAR(i)) {
-      seconds +=  SECS_PER_DAY;   // add extra days for leap years
-    }
-  }
-  
-  // add days for this year, months start from 1
-  for (i = 1; i < tm.Month; i++) {
-    if ( (i == 2) && LEAP_YEAR(tm.Year)) { 
-      seconds += SECS_PER_DAY * 29;
-    } else {
-      seconds += SECS_PER_DAY * monthDays[i-1];  //monthDay array starts from 0
-    }
-  }
-  seconds+= (tm.Day-1) * SECS_PER_DAY;
-  seconds+= tm.Hour * SECS_PER_HOUR;
-  seconds+= tm.Minute * SECS_PER_MIN;
-  seconds+= tm.Second;
-  return (time_t)seconds; 
+
+  // years since 1968 counting Jan and Feb with the year before
+  uint16_t year = tm.Year + 2 - (tm.Month <= 2);
+  uint8_t mp = tm.Month > 2 ? tm.Month - 3 : tm.Month + 9;
+  uint32_t days = (year / 4) * DAYS_PER_CYCLE + (year % 4) * 365
+    + (153 * mp + 2) / 5 + tm.Day - 1;
+  if (days > DAYS_1968_MAR_TO_2100_FEB29) days--;
+  days -= DAYS_1968_MAR_TO_1970;
+
+  return (time_t)(days * SECS_PER_DAY + tm.Hour * SECS_PER_HOUR
+    + tm.Minute * SECS_PER_MIN + tm.Second);
 }
 /*=====================================================*/	
 /* Low level system time functions  */
@@ -249,12 +230,15 @@ time_t sysUnsyncedTime = 0; // the time sysTime unadjusted by sync
 
 time_t now() {
 	// calculate number of seconds passed since last call to now()
-  while (millis() - prevMillis >= 1000) {
-		// millis() and prevMillis are both unsigned ints thus the subtraction will always be the absolute value of the difference
-    sysTime++;
-    prevMillis += 1000;	
+  // millis() and prevMillis are both unsigned ints thus the subtraction will always be the absolute value of the difference
+  uint32_t elapsed = millis() - prevMillis;
+  if (elapsed >= 1000) {
+    // catch up in one step after a long stall, the usual case needs no division
+    uint32_t secs = (elapsed < 2000) ? 1 : elapsed / 1000;
+    sysTime += secs;
+    prevMillis += secs * 1000;
 #ifdef TIME_DRIFT_INFO
-    sysUnsyncedTime++; // this can be compared to the synced time to measure long term drift     
+    sysUnsyncedTime += secs; // this can be compared to the synced time to measure long term drift     
 #endif
   }
   if (nextSyncTime <= sysTime) {
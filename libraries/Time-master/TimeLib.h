@@ -52,6 +52,12 @@ typedef struct  {
   uint8_t Year;   // offset from 1970; 
 } 	tmElements_t, TimeElements, *tmElementsPtr_t;
 
+// the current time and its broken down elements, see timeSnapshot()
+typedef struct  {
+  time_t Time;
+  tmElements_t Elements;
+} 	timeSnapshot_t;
+
 //convenience macros to convert to and from tm years 
 #define  tmYearToCalendar(Y) ((Y) + 1970)  // full four digit year 
 #define  CalendarYrToTm(Y)   ((Y) - 1970)
@@ -118,6 +124,7 @@ int     year();            // the full four digit year: (2009, 2010 etc)
 int     year(time_t t);    // the year for the given time
 
 time_t now();              // return the current time as seconds since Jan 1 1970 
+const timeSnapshot_t& timeSnapshot(); // now() plus its elements, only broken down once per second
 void    setTime(time_t t);
 void    setTime(int hr,int min,int sec,int day, int month, int yr);
 void    adjustTime(long adjustment);
@@ -130,6 +137,13 @@ char* monthShortStr(uint8_t month);
 char* dayShortStr(uint8_t day);
 	
 /* time sync functions	*/
+// Keep counting seconds from millis() without the syncs applied, compare
+// sysUnsyncedTime with now() to measure how far millis() drifts from the provider
+#define TIME_DRIFT_INFO
+#ifdef TIME_DRIFT_INFO
+extern time_t sysUnsyncedTime;
+#endif
+
 timeStatus_t timeStatus(); // indicates if time has been set and recently synchronized
 void    setSyncProvider( getExternalTime getTimeFunction); // identify the external time provider
 void    setSyncInterval(time_t interval); // set the number of seconds between re-sync
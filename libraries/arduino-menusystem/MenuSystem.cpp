@@ -10,7 +10,8 @@
 // *********************************************************
 
 MenuComponent::MenuComponent(const char* name)
-: _name(name)
+: _name(name),
+  _p_next(NULL)
 {
 }
 
@@ -33,7 +34,8 @@ Menu::Menu(const char* name, void (*callback)(Menu*))
 : MenuComponent(name),
   _disp_callback(callback),
   _p_sel_menu_component(NULL),
-  _menu_components(NULL),
+  _p_first_component(NULL),
+  _p_last_component(NULL),
   _p_parent(NULL),
   _num_menu_components(0),
   _cur_menu_component_num(0),
@@ -65,12 +67,12 @@ boolean Menu::next(boolean loop)
     } else if (_cur_menu_component_num != _num_menu_components - 1)
     {
         _cur_menu_component_num++;
-        _p_sel_menu_component = _menu_components[_cur_menu_component_num];
+        _p_sel_menu_component = _p_sel_menu_component->_p_next;
 
         return true;
     } else if (loop) {
         _cur_menu_component_num = 0;
-        _p_sel_menu_component = _menu_components[_cur_menu_component_num];
+        _p_sel_menu_component = _p_first_component;
 
         return true;
     }
@@ -86,13 +88,13 @@ boolean Menu::prev(boolean loop)
     } else if (_cur_menu_component_num != 0)
     {
         _cur_menu_component_num--;
-        _p_sel_menu_component = _menu_components[_cur_menu_component_num];
+        _p_sel_menu_component = component_at(_cur_menu_component_num);
 
         return true;
     } else if (loop)
     {
         _cur_menu_component_num = _num_menu_components - 1;
-        _p_sel_menu_component = _menu_components[_cur_menu_component_num];
+        _p_sel_menu_component = _p_last_component;
 
         return true;
     }
@@ -103,7 +105,7 @@ MenuComponent* Menu::activate()
 {
     if (!_num_menu_components) return NULL;
 
-    MenuComponent* pComponent = _menu_components[_cur_menu_component_num];
+    MenuComponent* pComponent = _p_sel_menu_component;
 
     if (pComponent == NULL)
         return NULL;
@@ -118,32 +120,27 @@ MenuComponent* Menu::select()
 
 void Menu::reset()
 {
-    for (int i = 0; i < _num_menu_components; ++i)
-        _menu_components[i]->reset();
+    for (MenuComponent* p = _p_first_component; p != NULL; p = p->_p_next)
+        p->reset();
 
     _prev_menu_component_num = 0;
     _cur_menu_component_num = 0;
-    _p_sel_menu_component = _num_menu_components ? _menu_components[0] : NULL;
+    _p_sel_menu_component = _p_first_component;
 }
 
-void Menu::add_item(MenuItem* pItem, void (*on_select)(MenuItem*))
+// Menus are short, walking the list beats keeping an array around
+MenuComponent* Menu::component_at(byte index) const
 {
-    // Resize menu component list, keeping existing items.
-    // If it fails, there the item is not added and the function returns.
-    _menu_components = (MenuComponent**) realloc(_menu_components,
-                                                 (_num_menu_components + 1)
-                                                 * sizeof(MenuComponent*));
-    if (_menu_components == NULL)
-      return;
-
-    _menu_components[_num_menu_components] = pItem;
+    MenuComponent* p = _p_first_component;
+    while (index--)
+        p = p->_p_next;
+    return p;
+}
 
+void Menu::add_item(MenuItem* pItem, void (*on_select)(MenuItem*))
+{
     pItem->set_select_function(on_select);
-
-    if (_num_menu_components == 0)
-        _p_sel_menu_component = pItem;
-
-    _num_menu_components++;
+    append(pItem);
 }
 
 Menu const* Menu::get_parent() const
@@ -158,29 +155,29 @@ void Menu::set_parent(Menu* pParent)
 
 Menu const* Menu::add_menu(Menu* pMenu)
 {
-    // Resize menu component list, keeping existing items.
-    // If it fails, there the item is not added and the function returns.
-    _menu_components = (MenuComponent**) realloc(_menu_components,
-                                                 (_num_menu_components + 1)
-                                                 * sizeof(MenuComponent*));
-    if (_menu_components == NULL)
-      return NULL;
-
     pMenu->set_parent(this);
+    append(pMenu);
 
-    _menu_components[_num_menu_components] = pMenu;
+    return pMenu;
+}
 
-    if (_num_menu_components == 0)
-        _p_sel_menu_component = pMenu;
+void Menu::append(MenuComponent* pComponent)
+{
+    pComponent->_p_next = NULL;
+    if (_p_last_component == NULL) {
+        _p_first_component = pComponent;
+        _p_sel_menu_component = pComponent;
+    } else {
+        _p_last_component->_p_next = pComponent;
+    }
+    _p_last_component = pComponent;
 
     _num_menu_components++;
-
-    return pMenu;
 }
 
 MenuComponent const* Menu::get_menu_component(byte index) const
 {
-  return _menu_components[index];
+  return component_at(index);
 }
 
 MenuComponent const* Menu::get_selected() const
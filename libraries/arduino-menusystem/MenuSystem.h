@@ -25,6 +25,12 @@ public:
 
 protected:
     const char* _name;
+
+private:
+    friend class Menu;
+    // Next one in the parent menu, components are kept as a list so
+    // adding them never allocates. A component can only be in one menu.
+    MenuComponent* _p_next;
 };
 
 
@@ -71,8 +77,12 @@ public:
     byte get_prev_menu_component_num() const;
 
 private:
+    MenuComponent* component_at(byte index) const;
+    void append(MenuComponent* pComponent);
+
     MenuComponent* _p_sel_menu_component;
-    MenuComponent** _menu_components;
+    MenuComponent* _p_first_component;
+    MenuComponent* _p_last_component;
     Menu* _p_parent;
     byte _num_menu_components;
     byte _cur_menu_component_num;
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+webassets.py - Gzips the static web interface in web/ into PROGMEM blobs
+in WebAssets.h, rerun it after changing anything in web/ or VERSION
+Created by D. Aaron Wisner
+Released into the public domain.
+"""
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+WEB_DIR = os.path.join(ROOT, 'web')
+OUT = os.path.join(ROOT, 'WebAssets.h')
+
+# Served path, file in web/, content type
+ASSETS = [
+    ('/', 'index.html', 'text/html'),
+    ('/app.css', 'app.css', 'text/css'),
+    ('/app.js', 'app.js', 'application/javascript'),
+]
+
+# Sizes of the WebAsset fields, including the terminator
+PATH_SIZE = 24
+TYPE_SIZE = 24
+ETAG_SIZE = 24
+
+
+def read_version():
+    with open(os.path.join(ROOT, 'FeederConfig.h')) as f:
+        m = re.search(r'#define\s+VERSION\s+"([^"]*)"', f.read())
+    if not m:
+        sys.exit('VERSION not found in FeederConfig.h')
+    return m.group(1)
+
+
+def symbol(name):
+    return 'web_' + re.sub(r'\W', '_', name)
+
+
+def main():
+    version = read_version()
+    blobs = []
+    for path, name, ctype in ASSETS:
+        if len(path) >= PATH_SIZE or len(ctype) >= TYPE_SIZE:
+            sys.exit('%s: path or content type too long' % name)
+        with open(os.path.join(WEB_DIR, name), 'rb') as f:
+            raw = f.read().replace(b'%VERSION%', version.encode())
+        # mtime=0 so the output only changes when the content does
+        data = gzip.compress(raw, compresslevel=9, mtime=0)
+        if len(data) > 0xFFFF:
+            sys.exit('%s: too big to serve' % name)
+        # Quoted as it goes on the wire, changes with the firmware or the file
+        etag = '"%s-%s"' % (version, hashlib.sha1(raw).hexdigest()[:8])
+        if len(etag) >= ETAG_SIZE:
+            sys.exit('%s: VERSION too long for the ETag' % name)
+        blobs.append((path, name, ctype, etag, data))
+        print('%-12s %5d -> %5d bytes' % (name, len(raw), len(data)))
+
+    out = []
+    out.append('/*')
+    out.append('  WebAssets.h - Gzipped web interface, generated by tools/webassets.py')
+    out.append('  from web/ for ' + version + ', do not edit by hand')
+    out.append('*/')
+    out.append('#ifndef WEB_ASSETS_H')
+    out.append('#define WEB_ASSETS_H')
+    out.append('')
+    out.append('#include <Arduino.h>')
+    out.append('')
+    out.append('#define WEB_ASSET_PATH_SIZE %d' % PATH_SIZE)
+    out.append('#define WEB_ASSET_TYPE_SIZE %d' % TYPE_SIZE)
+    out.append('#define WEB_ASSET_ETAG_SIZE %d' % ETAG_SIZE)
+    out.append('')
+    out.append('// Lives in flash, data is always gzip encoded')
+    out.append('typedef struct WebAsset')
+    out.append('{')
+    out.append('    char path[WEB_ASSET_PATH_SIZE];')
+    out.append('    char type[WEB_ASSET_TYPE_SIZE];')
+    out.append('    char etag[WEB_ASSET_ETAG_SIZE];')
+    out.append('    const uint8_t *data;')
+    out.append('    uint16_t len;')
+    out.append('} WebAsset;')
+    for path, name, ctype, etag, data in blobs:
+        out.append('')
+        out.append('// %s, %d bytes gzipped' % (name, len(data)))
+        # uint8_t, bytes over 0x7f narrow in a char initializer
+        out.append('const uint8_t %s[] PROGMEM = {' % symbol(name))
+        for i in range(0, len(data), 16):
+            out.append('    ' + ' '.join('0x%02x,' % b for b in data[i:i + 16]))
+        out.append('};')
+    out.append('')
+    out.append('const WebAsset webAssets[] PROGMEM = {')
+    for path, name, ctype, etag, data in blobs:
+        out.append('    { "%s", "%s", "%s", %s, sizeof(%s) },' % (path, ctype, etag.replace('"', '\\"'),
+                                                        symbol(name), symbol(name)))
+    out.append('};')
+    out.append('')
+    out.append('#endif')
+
+    with open(OUT, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
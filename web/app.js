@@ -0,0 +1,42 @@
+// Everything on the page comes from /events, the first message arrives
+// as soon as it connects and the rest only when something changes
+(function () {
+  var conn = document.getElementById('conn');
+  var cards = document.getElementById('cards');
+  var events = new EventSource('/events');
+
+  // The page doesn't know how many compartments the feeder has, each one
+  // gets a card the first time its door shows up
+  function door(i) {
+    var id = 'door' + (i + 1);
+    var el = document.getElementById(id);
+    if (!el) {
+      var card = document.createElement('div');
+      card.className = 'card';
+      card.innerHTML = '<h2>Feed #' + (i + 1) + '</h2><p>Door <span id="' + id + '">--</span></p>';
+      cards.appendChild(card);
+      el = document.getElementById(id);
+    }
+    return el;
+  }
+
+  events.onopen = function () {
+    conn.textContent = 'Live';
+  };
+  events.onerror = function () {
+    conn.textContent = 'Reconnecting...';
+  };
+  // Each message is [time, temp, pwm, doors], doors a '1' (open) or '0'
+  // per compartment, kept short since the link is slow
+  events.onmessage = function (e) {
+    var data = JSON.parse(e.data);
+    var fields = { time: data[0], temp: data[1], pwm: data[2] };
+    data[3].split('').forEach(function (open, i) {
+      door(i).textContent = open === '1' ? 'open' : 'closed';
+    });
+    for (var key in fields) {
+      var el = document.getElementById(key);
+      if (el) el.textContent = fields[key];
+    }
+  };
+})();